@@ -0,0 +1,24 @@
+#include <vector>
+#include <new>
+#include <cstddef>
+
+// allocator that aligns storage to A bytes (a cache line by default), so that flat grids start on a line boundary
+template <class T, std::size_t A = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <class U> struct rebind { using other = AlignedAllocator<U, A>; };
+    AlignedAllocator() {}
+    template <class U> AlignedAllocator(const AlignedAllocator<U, A>&) {}
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(A)));
+    }
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(A));
+    }
+    template <class U> bool operator==(const AlignedAllocator<U, A>&) const { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U, A>&) const { return false; }
+};
+
+// contiguous, cache line aligned array
+template <class T>
+using aligned_vector = std::vector<T, AlignedAllocator<T>>;
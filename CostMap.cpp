@@ -3,26 +3,148 @@
 #include <queue>
 #include <algorithm>
 #include <cmath>
+#include <memory>
+#include <span>
+#include <limits>
+#include <type_traits>
+#include <cstring>
+#include "OpenList.h"
+#include "AlignedVector.h"
+#include "ThreadPool.h"
+#include "PathCache.h"
+#include "MapFile.h"
+#include "SearchStats.h"
+#include "GridPolicies.h"
 
 using std::cout;
 using std::deque;
 using std::vector;
 using std::string;
 
-class CostMap;
-
-struct point { // or cell or coords
-    CostMap* map;
+struct point { // or cell or coords; inside a map a cell is also named by its index (see BasicCostMap::cell_index)
     int x;
     int y;
 };
 
-// class which stores a map of travel costs at each point and finds the optimal path between two points using the A* algorithm
-class CostMap {
+// start and goal of one path search
+struct query {
+    point start;
+    point goal;
+};
+
+// per-cell search data, indexed like CostMap::cell_costs: the path cost, and one packed byte with everything else. The
+// byte holds, from the lowest bit up:
+// - 3 bits: state, 0 = untouched, 1 = added to border, 2 = visited (see output_search), 5 = visited, then lowered and
+//   waiting for the next iteration of ARA* (3 and 4 are the path and waypoints of print_search_map)
+// - 4 bits: move from the previous cell of the minimum path into the cell, as an index into EightConnected, or NO_MOVE
+// - 1 unused bit
+// The search that last wrote the data is kept per block of BLOCK_SIZE cells, and data from older searches is stale: the
+// first time a search reaches a block, it resets the whole block. A cell takes the size of its path cost plus 1.25 bytes,
+// so 5.25 bytes with int or float path costs and 9.25 with doubles.
+template <class PathCost>
+struct AstarData {
+    static constexpr unsigned NO_MOVE = 15; // move of the first cell of a path, and of cells no path reached yet
+    static constexpr int BLOCK_BITS = 4;
+    static constexpr int BLOCK_SIZE = 1 << BLOCK_BITS; // cells that share a search id
+    aligned_vector<PathCost> path_cost; // cumulative cost of the minimum path found so far
+    aligned_vector<uint8_t> cell_data; // packed state and move
+    aligned_vector<uint32_t> block_id; // search that last reset each block of cells, or 0
+    vector<int> parent; // previous cell in the minimum path, only kept by Theta*, whose parents need not be neighbors
+    unsigned id = 0; // id of the current search, incremented by CostMap::begin_search; wraps to 0 after 2^32 - 1 searches
+    bool current(int c) { return block_id[c >> BLOCK_BITS] == id; }
+    size_t bytes() { return path_cost.capacity() * sizeof(PathCost) + cell_data.capacity() + block_id.capacity() * 4 + parent.capacity() * sizeof(int); }
+    int state(int c) { return cell_data[c] & 7; }
+    unsigned move(int c) { return cell_data[c] >> 3 & 15; }
+    void set_state(int c, int s) { cell_data[c] = (cell_data[c] & ~7u) | s; }
+    void set_move(int c, unsigned m) { cell_data[c] = (cell_data[c] & ~(15u << 3)) | m << 3; }
+    // reset the data of the block of cell c for the current search
+    void reset(int c) {
+        int b = c >> BLOCK_BITS;
+        block_id[b] = id;
+        int end = std::min<int>((b + 1) * BLOCK_SIZE, cell_data.size());
+        for (int i = b * BLOCK_SIZE; i < end; i++) {
+            cell_data[i] = NO_MOVE << 3;
+            path_cost[i] = std::numeric_limits<PathCost>::max();
+        }
+    }
+};
+
+// everything a path search writes to: search data, borders and results. A context is reused by consecutive searches so
+// its memory is only allocated once, but it can only be used by one search at a time.
+template <class PathCost>
+struct SearchContext {
+    AstarData<PathCost> astar_data;
+    AstarData<PathCost> astar_data_back; // search data of the backward search of a bidirectional search
+    std::unique_ptr<OpenList> border;
+    std::unique_ptr<OpenList> border_back; // border of the backward search
+    char border_type = 0; // open list type that border and border_back were created with
+    point start;
+    point goal;
+    int cur_cell; // index of the cell being expanded
+    deque<point> path;
+    deque<point> waypoints;
+    int expansions = 0; // number of cells taken from the border
+    double weight = 1; // factor of the heuristic in the keys of the border, above 1 only in ARA*
+    double suboptimality = 1; // the cost of path is at most this many times the minimum
+    vector<int> closed; // cells expanded by the current iteration of ARA*
+    vector<int> inconsistent; // cells of ARA* whose cost went down after the current iteration expanded them
+    SearchStats stats; // counters and times of the last search, if COSTMAP_STATS is defined
+};
+
+// receives events from Map::find_path; every event does nothing unless overridden
+template <class Map>
+class BasicSearchObserver {
+public:
+    virtual ~BasicSearchObserver() {}
+    virtual void on_expand(Map& map, point p) {} // a cell was taken from the border to update its neighbors
+    virtual void on_relax(Map& map, point p, double path_cost) {} // the path cost of a cell was lowered
+    virtual void on_path_found(Map& map, const deque<point>& path) {} // the search reached the goal and the path and waypoints are set
+};
+
+// class which stores a map of travel costs at each point and finds the optimal path between two points using the A* algorithm.
+// CellCost is the type of the cell costs and PathCost the type of the path costs. Integer path costs add up exactly, but
+// they cannot hold the length of a diagonal move, so they only work on the 4-connected grid and not with Theta*.
+// Map files always store doubles.
+template <class CellCost = double, class PathCost = double>
+class BasicCostMap {
 public:
+    using SearchObserver = BasicSearchObserver<BasicCostMap>;
     // ----- MAP -----
     // Constructor
-    CostMap(int h, int w, point p, double m = 1, char t = 'e') : height(h), width(w), pos(p), min(m), heuristic_type(t) {
+    BasicCostMap(int h, int w, point p, CellCost m = 1, char t = 'e', char o = 'd') : height(h), width(w), pos(p), min(m), heuristic_type(t), open_list_type(o) {
+        if (min <= 0) {
+            cout << "error: min cost value must be positive\n";
+            exit(1);
+        }
+        if (!in_bounds(pos)) {
+            cout << "error: pos out of bounds\n";
+            exit(1);
+        }
+        cell_storage.assign(width * height, min);
+        cell_costs = cell_storage.data();
+    }
+    // load a binary map file (see MapFile.h), mapping its costs into memory instead of reading them; the costs of a
+    // tiled map file are read one tile at a time when they are needed, keeping at most tile_cache tiles in memory
+    BasicCostMap(const string& filename, char t = 'e', char o = 'd', int tile_cache = 1024) : heuristic_type(t), open_list_type(o) {
+        MapHeader header;
+        if (!read_map_header(filename, header)) {
+            cout << "error: cannot read file " << filename << '\n';
+            exit(1);
+        }
+        if (string(header.magic, 4) != "CMAP" || header.version != MAP_FILE_VERSION) {
+            cout << "error: " << filename << " is not a version " << MAP_FILE_VERSION << " map file\n";
+            exit(1);
+        }
+        width = header.width;
+        height = header.height;
+        min = header.min;
+        pos = {header.pos_x, header.pos_y};
+        goal = {header.goal_x, header.goal_y};
+        bool opened = header.tile_size > 0 ? tiles.open(filename, tile_cache) : map_file.open(filename);
+        if (width <= 0 || height <= 0 || !opened || header.tile_size < 0 || (header.tile_size == 0 && map_file.size() != sizeof(MapHeader) + (size_t)width * height * sizeof(double))) {
+            cout << "error: size of " << filename << " does not match its header\n";
+            exit(1);
+        }
         if (min <= 0) {
             cout << "error: min cost value must be positive\n";
             exit(1);
@@ -31,33 +153,49 @@ public:
             cout << "error: pos out of bounds\n";
             exit(1);
         }
-        cell_costs.resize(width);
-        astar_data.resize(width);
-        for (int i = 0; i < width; i++) {
-	        cell_costs[i].resize(height, min);
-            astar_data[i].resize(height);
+        if (tiles.is_open()) cell_costs = nullptr;
+        else if constexpr (std::is_same_v<CellCost, double>) cell_costs = (double*)(map_file.data() + sizeof(MapHeader));
+        else {
+            // other cost types cannot point into the file, so the costs are converted into memory
+            const double* costs = (const double*)(map_file.data() + sizeof(MapHeader));
+            cell_storage.assign(costs, costs + (size_t)width * height);
+            cell_costs = cell_storage.data();
+            map_file.close();
         }
     }
     // Functions
     bool in_bounds(point p); // whether a point is in the map
-    void set_cell_cost(point p, double cost); // set the cost of a single cell
-    double get_cell_cost(point p); // get the cost of a single cell
+    void set_cell_cost(point p, CellCost cost); // set the cost of a single cell
+    CellCost get_cell_cost(point p); // get the cost of a single cell
+    int cell_index(point p); // index of a cell, y * width + x, as used by cell_costs, the search data, open lists and the path cache
+    point cell_point(int c); // cell with the given index
     void reshape_top(int n); // add n > 0 or remove -n > 0 rows to/from the top side of the cost map
     void reshape_bottom(int n); // add n > 0 or remove -n > 0 rows to/from the bottom side of the cost map
     void reshape_right(int n); // add n > 0 or remove -n > 0 columns to/from the right side of the cost map
     void reshape_left(int n); // add n > 0 or remove -n > 0 columns to/from the left side of the cost map
+    void save(const string& filename, int tile_size = 0); // write the map, pos and goal to a binary map file, tiled if tile_size > 0
+    void scroll(int dx, int dy); // move the map window by dx columns and dy rows over the world, keeping pos on the same world cell
+    point to_window(point world); // map cell at world coordinates
+    point to_world(point p); // world coordinates of a map cell
+    size_t tile_search_bytes(); // memory held by the search data of a tiled map: that of the tiles the last search reached
     // Variables
     point pos;
-    double min;
+    CellCost min;
     int width;
     int height;
+    TileStore tiles; // costs of a tiled map file, paged in on demand; not open for maps in memory
+    int origin_x = 0; // world coordinates of cell (0, 0), moved by scroll and reshape
+    int origin_y = 0;
 
     // ----- A* -----
     // Functions
     point get_goal(); // destination of travel
-    double get_path_cost(point p); // cumulative cost of the minimum path to point p
-    double heuristic(point p1, point p2); // minimum cost of path between two points
+    PathCost get_path_cost(point p); // cumulative cost of the minimum path to point p
+    unsigned long long get_map_version(); // number of changes made to the map so far
+    size_t search_bytes(); // memory allocated for the search data of find_path
+    double heuristic(point p1, point p2); // minimum cost of path between two points, with the heuristic of heuristic_type
     deque<point> find_path(point g); // find the optimal path to a goal g using the A* algorithm
+    vector<deque<point>> find_paths(std::span<const query> queries, int threads = 0); // find the waypoints of many paths in parallel
     void print_cell_cost_map(); // print the movement cost of each cell
     void print_path_cost_map(); // print the cumulative cost of the minimum path to each cell evaluated so far
     void print_search_map(); // print evaluation status of each cell
@@ -65,200 +203,696 @@ public:
     // Variables
     deque<point> path;
     deque<point> waypoints;
-    char heuristic_type;
+    char heuristic_type; // 'm' = Manhattan (octile with connectivity 8), 'c' = Chebyshev, 'e' = Euclidean, 'o' = octile, 'l' = landmarks (ALT, see build_landmarks)
+    int connectivity = 4; // neighbors of each cell: 4 = sides, 8 = sides and corners (diagonal moves cost sqrt(2) times the cell cost); JPS, D* Lite, HPA* and tiled maps always use 4
+    char open_list_type; // 'b' = binary heap, 'q' = 4-ary heap, 'p' = pairing heap, 'd' = bucket queue (Dial's algorithm) where the keys are integers, otherwise binary heap
+    SearchObserver* observer = nullptr; // receives search events if set; find_path prints nothing on its own
+    // engine of find_path and find_paths: 'a' = A*, 'j' = jump point search, 'p' = jump point search with precomputed jump
+    // distances (JPS+), 'b' = bidirectional A*, 'd' = D* Lite, 'h' = HPA*, 't' = Theta* (any-angle), 'r' = ARA* (anytime).
+    // Tiled maps search with A* whatever the engine. find_paths searches with A* instead of D* Lite and HPA*, which keep
+    // one search state per map and so cannot run queries in parallel.
+    char search_type = 'a';
+    int expansions = 0; // number of cells taken from the border by the last search
+    SearchStats stats; // statistics of the last find_path, if COSTMAP_STATS is defined
+    StatsHistogram histogram; // statistics of all find_path and find_paths queries, if COSTMAP_STATS is defined
+    PathCache cache; // paths found by find_path, reused while the map does not change
+    int cluster_size = 16; // width and height of the clusters of HPA*
+    double anytime_weight = 2.5; // weight of the heuristic in the first iteration of ARA*, whose path costs at most that many times the minimum
+    double anytime_budget_ms = 5; // time ARA* may take to improve its first path; the first path is always found
+    double suboptimality = 1; // the cost of the last path is at most this many times the minimum; infinity for HPA* and Theta*, which give no bound
+
+    // ----- FLOW FIELD -----
+    // Functions
+    void build_flow_field(point g); // find the minimum path from every cell to g, with the neighbors of connectivity
+    point flow_step(point p); // next cell of the minimum path from p to the flow field goal, or p at the goal
+    deque<point> flow_path(point p); // cells of the minimum path from p to the flow field goal, from p to the goal
+    PathCost flow_cost(point p); // cost of the minimum path from p to the flow field goal
+
+    // ----- LANDMARKS -----
+    // Functions
+    void build_landmarks(int count, int threads = 0); // place count landmarks and find the minimum path costs from and to each of them, in parallel
+    void save_landmarks(const string& filename); // write the landmarks and their path costs to a file
+    void load_landmarks(const string& filename); // read landmarks written by save_landmarks for a map with the same costs
 
 private:
     // ----- MAP -----
     // Variables
-    deque<deque<double>> cell_costs;
-    point goal;
+    CellCost* cell_costs; // row-major: the cost of cell (x, y) is at y * width + x; points into cell_storage or map_file
+    aligned_vector<CellCost> cell_storage; // cell costs, unless they were loaded from a file
+    bool ring = false; // whether cell_storage is a scrolling ring (see scroll)
+    MappedFile map_file; // file the cell costs were loaded from; changed pages are private copies, the file is not written
+    point goal = {0, 0};
+    static constexpr int BUCKET_MAX_COST = 4096; // largest cell cost of the bucket queue, which keeps about that many buckets
+    int unbucketed_cells = -1; // cells whose cost is not an integer in [1, BUCKET_MAX_COST], or -1 if not counted since the costs last changed in bulk
+    // Functions
+    static bool bucketable(CellCost cost); // whether a cell cost is an integer in [1, BUCKET_MAX_COST]
+    bool integer_costs(); // whether every cell cost is bucketable, counting them if needed
+    void reshape(int top, int bottom, int left, int right); // add (> 0) or remove (< 0) rows and columns on each side of the cost map
+    void make_ring(); // store the cell costs as a scrolling ring
+    void set_ring_cost(int c, CellCost cost); // set the cost of cell c in both copies of the ring
 
     // ----- A* -----
     // Structs
-    struct CellAstarData { // or [Cell]AstarInfo or CellPath[Data/Info]
-        point prev = {0, 0, 0};
-        double path_cost = std::numeric_limits<double>::max();
-        int added = 0;
-        int visited = 0; // only for record keeping
+    struct NoObserver { // stands in for a missing observer so the search loop compiles without event calls
+        void on_expand(BasicCostMap& map, point p) {}
+        void on_relax(BasicCostMap& map, point p, double path_cost) {}
     };
     // Variables
-    deque<deque<CellAstarData>> astar_data;
-    vector<point> border;
-    point cur_pt;
-    bool updated_since_astar = false;
+    SearchContext<PathCost> context; // search state of find_path
+    std::unique_ptr<WorkStealingPool> pool; // worker threads of find_paths
+    vector<SearchContext<PathCost>> worker_contexts; // search state of each worker of find_paths
+    unsigned long long map_version = 0; // incremented on every change to the map, so cached paths of older maps are not used
+    int cache_connectivity = 4; // connectivity of the paths in cache
+    vector<int> cache_cells; // cells of the path being moved to or from the cache
     // Functions
-    void reset_astar(); // prepare for next astar path search
-    void update_neighbors(); // update attributes of neighboring cells (based on current cell attributes)
-    void find_waypoints(); // find waypoints in the path, for smooth movement
-    int output_search(point p); // search results: 0 = untouched, 1 = added to border (evaluating cost), 2 = visited (cost evaluated), 3 = path (minimum cost)
-    int output_path_cost(point p); // cumulative cost of the minimum path to point p, but replace max double values with 0
-};
+    // The search functions only read the map and write to the given context, so searches with different contexts can run
+    // at the same time as long as the map is not changed.
+    template <class Observer> void search(SearchContext<PathCost>& ctx, point start, point g, Observer& obs); // find the path and waypoints from start to g
+    template <class Heuristic, class Observer> void search_connected(SearchContext<PathCost>& ctx, point start, point g, Observer& obs); // search with the neighborhood of connectivity
+    template <class Heuristic, class Neighborhood, class Observer> void search_with(SearchContext<PathCost>& ctx, point start, point g, Observer& obs); // search with the given policies
+    void find_path_cached(); // find the path to goal with the engine of search_type, or reuse it from the cache
+    void reset_astar(SearchContext<PathCost>& ctx, char type); // prepare for next astar path search, with open lists of the given type
+    void begin_search(AstarData<PathCost>& data); // start a new search id, clearing the search data if the map was reshaped or the id wrapped
+    char list_type(bool integer_keys); // open list type of a search, with the bucket queue of 'd' only if the search has integer keys and costs
+    OpenList* make_open_list(char type); // create an empty open list of the given type
+    static PathCost move_cost(CellCost cost, double length); // cost of a move of the given length into a cell of the given cost
+    void touch(AstarData<PathCost>& data, int c); // reset the search data of a cell, with its block, if it is stale, before it is used in the current search
+    template <class Heuristic, class Neighborhood, class Observer> void expand_border(SearchContext<PathCost>& ctx, Observer& obs); // expand the border until the goal is reached
+    template <class Heuristic, class Neighborhood, class Observer> void update_neighbors(SearchContext<PathCost>& ctx, Observer& obs); // update attributes of neighboring cells (based on current cell attributes)
+    void trace_path(SearchContext<PathCost>& ctx); // set the path from the moves of the cells, from the goal back to the start
+    void find_waypoints(SearchContext<PathCost>& ctx); // find waypoints in the path, for smooth movement
+    void load_path(const vector<int>& cells); // set path and waypoints to a known minimum path, with its path costs
+    int output_search(point p); // search results: 0 = untouched, 1 = added to border (evaluating cost), 2 = visited (cost evaluated), 3 = path (minimum cost), 4 = waypoint, 5 = visited and lowered by ARA*
+    int output_path_cost(point p); // cumulative cost of the minimum path to point p, but replace max values with 0
+    template <class Heuristic> double estimate(point p1, point p2); // minimum cost of path between two points, with the given heuristic
+    template <class Heuristic> OpenEntry open_entry(SearchContext<PathCost>& ctx, int c); // open list entry of a cell with its current path cost
+    template <class Heuristic> void relax(SearchContext<PathCost>& ctx, int c, int move, PathCost new_cost); // lower the path cost of cell c to new_cost via the given move into it, and add it to or move it up in the border
+    int prev_cell(AstarData<PathCost>& data, int c); // previous cell of cell c in its minimum path, or -1 at the start of the path
+    unsigned move_between(int from, int to); // move from cell from into its neighbor to, as an index into EightConnected
 
-// determine which point has the lower cost according to the A* algorithm
-class cheaper {
-public:
-    bool operator() (point p1, point p2) {
-        if (p1.map != p2.map) {
-            cout << "error: two points from different path searches compared\n";
-            exit(1);
-        }
-        double p1_total = p1.map->get_path_cost(p1) + p1.map->heuristic(p1, p1.map->get_goal());
-        double p2_total = p2.map->get_path_cost(p2) + p2.map->heuristic(p2, p2.map->get_goal());
-        return p1_total > p2_total;
-    }
+    // ----- JPS -----
+    // Variables
+    aligned_vector<int> jump_dist; // for each cell and direction, steps to the next jump point (> 0) or minus the steps to the edge of the map (<= 0)
+    bool jump_dist_stale = true; // whether jump_dist has to be rebuilt before the next JPS+ search
+    // Functions
+    bool is_uniform(int x, int y); // whether a cell is in the map and has the minimum cost
+    bool is_jump_stop(int x, int y); // whether a cell is non-uniform or next to a non-uniform cell, so every jump stops at it
+    bool has_forced_neighbor(int x, int y, int dy); // whether a vertical jump moving in direction dy must stop at a cell to turn sideways
+    int jump(SearchContext<PathCost>& ctx, int c, int dir, int& steps); // jump from cell c in direction dir; return the jump point reached and the steps taken, or -1
+    int scan(int c, int dir, int& steps); // jump by scanning the map cell by cell, ignoring the goal
+    void build_jump_dist(); // precompute the jump distances in every direction for JPS+
+    template <class Heuristic, class Observer> void update_jump_points(SearchContext<PathCost>& ctx, Observer& obs); // update attributes of the jump points reachable from the current cell
+    int jump_origin(AstarData<PathCost>& data, int c); // cell that the jump into cell c was made from, or one with a path of the same cost
+
+    // ----- BIDIRECTIONAL -----
+    // Functions
+    template <class Heuristic, class Neighborhood, class Observer> void expand_bidirectional(SearchContext<PathCost>& ctx, Observer& obs); // expand the forward and backward borders until the minimum path is found
+
+    // ----- THETA* -----
+    // Functions
+    template <class Heuristic, class Neighborhood, class Observer> void update_any_angle(SearchContext<PathCost>& ctx, Observer& obs); // update neighboring cells with a move from the current cell or a line from its parent
+    template <class Visit> void trace_line(int from, int to, Visit visit); // call visit for each cell that the line from cell from to cell to enters, in order
+    PathCost line_cost(int from, int to); // cost of moving in a straight line from cell from to cell to
+    void any_angle_path(SearchContext<PathCost>& ctx); // set the path and waypoints of an any-angle search from the parents of the goal
+
+    // ----- ARA* -----
+    // Functions
+    template <class Heuristic, class Neighborhood, class Observer> void expand_anytime(SearchContext<PathCost>& ctx, Observer& obs); // find a path with a weighted heuristic, then improve it while lowering the weight
+    template <class Heuristic, class Neighborhood, class Observer> void update_anytime(SearchContext<PathCost>& ctx, Observer& obs); // update neighboring cells, leaving cells expanded by this iteration for the next one
+    void sum_path_costs(SearchContext<PathCost>& ctx); // set the path costs of the cells of the path to the costs of its moves
+
+    // ----- D* LITE -----
+    // Variables
+    aligned_vector<PathCost> dstar_g; // cost of the minimum path from each cell to the goal, as of its last expansion
+    aligned_vector<PathCost> dstar_rhs; // cost of the minimum path from each cell to the goal, based on the g of its neighbors
+    std::unique_ptr<OpenList> dstar_border; // cells whose g and rhs differ
+    point dstar_goal; // goal of the kept search
+    point dstar_start; // pos when the kept search was last updated
+    double dstar_km; // sum of the heuristic between the starts of consecutive updates, added to keys so they stay valid
+    char dstar_heuristic_type; // heuristic_type of the kept search
+    char dstar_border_type; // open list type of the kept search
+    bool dstar_valid = false; // whether the kept search can be updated, or has to start over
+    vector<int> changed_cells; // cells whose cost was set since the kept search was last updated
+    // Functions
+    template <class Observer> deque<point> find_path_incremental(Observer& obs); // find the optimal path to goal, reusing the previous search
+    void dstar_reset(); // start a new search from goal
+    OpenEntry dstar_key(int c); // key of a cell in dstar_border
+    void dstar_update_rhs(int c); // recompute the rhs of a cell from its neighbors
+    void dstar_update_cell(int c); // add, move or remove a cell in dstar_border depending on its g and rhs
+    template <class Observer> void dstar_expand(Observer& obs); // expand cells until the path from pos is known to be minimal
+
+    // ----- HPA* -----
+    // Structs
+    struct HpaCluster { // rectangle of cells, with the abstract nodes on its border
+        int x0, y0, w, h;
+        vector<int> nodes; // abstract nodes in the cluster
+        vector<PathCost> costs; // costs[i * nodes.size() + j] = cost of the minimum path from nodes[i] to nodes[j] inside the cluster
+        bool stale; // costs have to be recomputed because a cell cost changed
+    };
+    struct HpaNode { // cell next to a neighboring cluster, where abstract paths cross the border
+        int cell;
+        int cluster;
+        int slot; // index in the nodes of the cluster
+        int link; // node on the other side of the border
+    };
+    // Variables
+    vector<HpaCluster> clusters;
+    vector<HpaNode> hpa_nodes;
+    int clusters_x; // clusters per row
+    int hpa_built_size = 0; // cluster_size the clusters were built with, or 0 if they have to be built
+    vector<PathCost> local_cost; // path cost of each cell of a cluster, from cluster_search
+    vector<int> local_prev; // previous cell of each cell of a cluster, from cluster_search
+    vector<PathCost> hpa_cost; // path cost of each abstract node, then the start and the goal
+    vector<int> hpa_prev; // previous abstract node in that path
+    vector<PathCost> hpa_to_goal; // cost from each node of the goal's cluster to the goal
+    std::unique_ptr<OpenList> hpa_border;
+    char hpa_border_type = 0; // open list type that hpa_border was created with
+    // Functions
+    template <class Observer> deque<point> find_path_hierarchical(Observer& obs); // find a near-optimal path to goal through the abstract graph
+    void build_clusters(); // partition the map into clusters and place the abstract nodes on their borders
+    void add_transition(int a, int b); // add linked abstract nodes for the neighboring cells a and b of different clusters
+    void update_cluster(int k); // recompute the costs between the nodes of cluster k
+    int cluster_of(int c); // cluster of a cell
+    int local_index(int k, int c); // index of cell c in the local data of cluster k
+    void cluster_search(int k, int from, int to); // find minimum paths from cell from inside cluster k, stopping at cell to if it is not -1
+
+    // ----- TILED -----
+    // Structs
+    struct TileSearch { // search data of the cells of one tile, allocated when a search first reaches the tile
+        unsigned id = 0; // search that last reset the data
+        vector<PathCost> path_cost;
+        vector<char> prev; // direction of the move from the previous cell in the minimum path (see FourConnected), or -1
+        vector<char> state; // as in AstarData
+    };
+    // Variables
+    vector<std::unique_ptr<TileSearch>> tile_search; // search data of each tile, or null if the last search did not reach it
+    vector<int> tile_search_live; // tiles whose search data is allocated
+    unsigned tile_search_id = 0; // id of the current search of a tiled map
+    // Functions
+    template <class Observer> void find_path_tiled(point start, point g, Observer& obs); // find the optimal path from start to g on a tiled map
+    TileSearch& tile_data(int x, int y); // search data of the tile of cell (x, y), reset if it is stale
+    TileSearch* current_tile_data(int x, int y); // search data of the tile of cell (x, y) if the current search reached it, or null
+    int tile_offset(int x, int y); // index of cell (x, y) in the search data of its tile
+
+    // ----- FLOW FIELD -----
+    // Variables
+    aligned_vector<PathCost> flow_dist; // cost of the minimum path from each cell to the flow field goal
+    aligned_vector<unsigned char> flow_dir; // move from each cell to the next cell of that path, as an index into EightConnected, or FLOW_GOAL
+    std::unique_ptr<OpenList> flow_border;
+    char flow_border_type = 0; // open list type that flow_border was created with
+    point flow_goal; // goal of the flow field in world coordinates, so it can be found again after reshape and scroll
+    int flow_connectivity = 4; // connectivity the flow field was built with
+    bool flow_built = false; // whether build_flow_field was called
+    bool flow_stale = false; // whether the flow field has to be built again because the map was reshaped or scrolled
+    vector<int> flow_changed; // cells whose cost was set since the flow field was last updated
+    vector<int> flow_cells; // cells whose path is recomputed by an update
+    // Functions
+    void update_flow_field(); // bring the flow field up to date with the map
+    template <class Neighborhood> void flow_update(); // recompute the cells whose minimum path changed with the costs of flow_changed
+    template <class Neighborhood> void flow_expand(); // expand flow_border until every cell has its minimum path
+    int flow_next(int c); // cell index of the next cell of the minimum path from cell c, or c at the goal
+
+    // ----- LANDMARKS -----
+    // Types
+    using LandmarkCost = std::conditional_t<std::is_integral_v<PathCost>, PathCost, float>; // path cost in the landmark table
+    // Variables
+    vector<int> landmarks; // cells of the landmarks
+    aligned_vector<LandmarkCost> landmark_costs; // for each cell c and landmark k, the cost of the minimum path from the landmark to c at (c * landmarks.size() + k) * 2, and from c to the landmark after it
+    int landmark_connectivity = 4; // connectivity the landmark table was built with
+    bool landmarks_valid = false; // whether the table bounds the current costs: no cost went down and the map was not reshaped or scrolled since it was built
+    vector<vector<double>> landmark_scratch; // path costs of the current search of each worker of build_landmarks
+    // Functions
+    bool use_landmarks(); // whether the search of search_type can use the landmark table as its heuristic
+    template <class Neighborhood> void landmark_search(int landmark, bool to_landmark, vector<double>& dist); // find the minimum path costs from a landmark to every cell, or from every cell to it
+    double landmark_bound(int a, int b); // lower bound of the cost of the minimum path from cell a to cell b
+    uint64_t cost_hash(); // hash of the cell costs, to check that a landmark file belongs to the map
 };
 
+const unsigned char FLOW_GOAL = 255; // flow_dir of the goal, which has no next cell
+
+const double ANYTIME_WEIGHT_STEP = 0.5; // amount ARA* lowers the weight of the heuristic by after each path
+const int ANYTIME_LOWERED = 5; // search state of a cell whose cost went down after the current iteration of ARA* expanded it
+
+const double LANDMARK_ROUNDING = 1.0 / (1 << 23); // relative rounding error of a float landmark cost, with room to spare
+
 // ----- MAP -----
 
 // whether a point is in the map
-bool CostMap::in_bounds(point p) {
+template <class CellCost, class PathCost>
+bool BasicCostMap<CellCost, PathCost>::in_bounds(point p) {
     return 0 <= p.x && p.x < width && 0 <= p.y && p.y < height;
 }
 
 // set the cost of a single cell
-void CostMap::set_cell_cost(point p, double cost) {
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::set_cell_cost(point p, CellCost cost) {
     if (cost <= 0) {
         cout << "error: cost must be positive\n";
         exit(1);
     }
     else if (cost < min)
         cout << "warning: cost less than heuristic minimum; solution not guaranteed to be optimal\n";
-    updated_since_astar = true;
-    cell_costs[p.x][p.y] = cost;
+    map_version++;
+    if (tiles.is_open()) {
+        tiles.set(p.x, p.y, cost);
+        return;
+    }
+    jump_dist_stale = true;
+    if (cost < cell_costs[cell_index(p)]) landmarks_valid = false;
+    if (unbucketed_cells >= 0) unbucketed_cells += !bucketable(cost) - !bucketable(cell_costs[cell_index(p)]);
+    if (ring) set_ring_cost(cell_index(p), cost);
+    else cell_costs[cell_index(p)] = cost;
+    if (hpa_built_size) clusters[cluster_of(cell_index(p))].stale = true;
+    // remember the change for D* Lite, unless there are so many that starting over is cheaper
+    if (dstar_valid) {
+        if (changed_cells.size() < (size_t)width * height) changed_cells.push_back(cell_index(p));
+        else dstar_valid = false;
+    }
+    // same for the flow field
+    if (flow_built && !flow_stale) {
+        if (flow_changed.size() < (size_t)width * height) flow_changed.push_back(cell_index(p));
+        else flow_stale = true;
+    }
 }
 
 // get the cost of a single cell
-double CostMap::get_cell_cost(point p) {
-    return cell_costs[p.x][p.y];
+template <class CellCost, class PathCost>
+CellCost BasicCostMap<CellCost, PathCost>::get_cell_cost(point p) {
+    if (tiles.is_open()) return tiles.get(p.x, p.y);
+    return cell_costs[cell_index(p)];
+}
+
+// write the map, pos and goal to a binary map file
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::save(const string& filename, int tile_size) {
+    MapHeader header = make_map_header(width, height, min, pos.x, pos.y, goal.x, goal.y, tile_size);
+    if (tile_size == 0 && tiles.is_open()) {
+        cout << "error: a tiled map can only be saved as a tiled map\n";
+        exit(1);
+    }
+    // the new file replaces the old one, so a tiled map saved to its own file has to open it again to keep its changes
+    bool reopen = tiles.is_open() && tiles.is_file(filename);
+    bool written;
+    if (tile_size > 0) written = write_tiled_map_file(filename, header, [this](int x, int y) { return get_cell_cost({x, y}); });
+    else if constexpr (std::is_same_v<CellCost, double>) written = write_map_file(filename, header, cell_costs);
+    else {
+        // map files store doubles
+        vector<double> costs(cell_costs, cell_costs + width * height);
+        written = write_map_file(filename, header, costs.data());
+    }
+    if (!written) {
+        cout << "error: cannot write file " << filename << '\n';
+        exit(1);
+    }
+    if (reopen && !tiles.open(filename, tiles.capacity())) {
+        cout << "error: cannot read file " << filename << '\n';
+        exit(1);
+    }
+}
+
+// add (> 0) or remove (< 0) rows and columns on each side of the cost map
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::reshape(int top, int bottom, int left, int right) {
+    if (tiles.is_open()) {
+        cout << "error: a tiled map cannot be reshaped\n";
+        exit(1);
+    }
+    int new_width = width + left + right;
+    int new_height = height + top + bottom;
+    aligned_vector<CellCost> new_costs(new_width * new_height, min);
+    // copy the rows and columns that are in both maps
+    for (int y = std::max(0, -top); y < std::min(height, height + bottom); y++) {
+        CellCost* row = cell_costs + y * width;
+        std::copy(row + std::max(0, -left), row + std::min(width, width + right),
+                  new_costs.begin() + (y + top) * new_width + std::max(0, left));
+    }
+    cell_storage.swap(new_costs);
+    cell_costs = cell_storage.data();
+    ring = false;
+    map_file.close();
+    unbucketed_cells = -1;
+    jump_dist_stale = true;
+    dstar_valid = false;
+    hpa_built_size = 0;
+    flow_stale = true;
+    landmarks_valid = false;
+    width = new_width;
+    height = new_height;
+    origin_x -= left;
+    origin_y -= top;
+}
+
+// whether a cell cost is an integer in [1, BUCKET_MAX_COST]
+template <class CellCost, class PathCost>
+bool BasicCostMap<CellCost, PathCost>::bucketable(CellCost cost) {
+    return 1 <= cost && cost <= BUCKET_MAX_COST && cost == std::floor(cost);
+}
+
+// whether every cell cost is bucketable, counting them if needed
+template <class CellCost, class PathCost>
+bool BasicCostMap<CellCost, PathCost>::integer_costs() {
+    // the costs of a tiled map are not all in memory
+    if (tiles.is_open()) return false;
+    if (unbucketed_cells < 0) unbucketed_cells = std::count_if(cell_costs, cell_costs + width * height, [](CellCost cost) { return !bucketable(cost); });
+    return unbucketed_cells == 0;
+}
+
+// A scrolling map keeps its costs in a ring: cell_storage holds two copies of the width * height costs back to back,
+// and cell_costs points at the current start of the window in the first copy. Since cell c of the window is at the
+// same place in both copies, cell_costs[c] never runs past the end, so searches index the map as usual. Moving the
+// window by k cells in row-major order moves cell_costs by k (wrapping within the first copy): shifting by dy rows is
+// k = dy * width, and shifting by dx columns is k = dx, since the cells that wrap into the next row are the ones that
+// left the window. Only the cells that enter the window are set to min, in both copies.
+
+// move the map window by dx columns and dy rows over the world, keeping pos on the same world cell
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::scroll(int dx, int dy) {
+    if (tiles.is_open()) {
+        cout << "error: a tiled map cannot be scrolled\n";
+        exit(1);
+    }
+    if (!in_bounds({pos.x - dx, pos.y - dy})) {
+        cout << "error: pos out of bounds\n";
+        exit(1);
+    }
+    if (dx == 0 && dy == 0) return;
+    if (!ring) make_ring();
+    int n = width * height;
+    int offset = cell_costs - cell_storage.data();
+    // shift the window, then set the cells that entered it
+    if (std::abs(dx) >= width || std::abs(dy) >= height) {
+        for (int c = 0; c < n; c++)
+            set_ring_cost(c, min);
+    }
+    else {
+        offset = ((offset + dx) % n + n) % n;
+        cell_costs = cell_storage.data() + offset;
+        for (int y = 0; y < height; y++)
+            for (int x = dx > 0 ? width - dx : 0; x < (dx > 0 ? width : -dx); x++)
+                set_ring_cost(y * width + x, min);
+        offset = ((offset + dy * width) % n + n) % n;
+        cell_costs = cell_storage.data() + offset;
+        for (int y = dy > 0 ? height - dy : 0; y < (dy > 0 ? height : -dy); y++)
+            for (int x = 0; x < width; x++)
+                set_ring_cost(y * width + x, min);
+    }
+    origin_x += dx;
+    origin_y += dy;
+    pos.x -= dx;
+    pos.y -= dy;
+    map_version++;
+    unbucketed_cells = -1;
+    jump_dist_stale = true;
+    dstar_valid = false;
+    hpa_built_size = 0;
+    flow_stale = true;
+    landmarks_valid = false;
+}
+
+// map cell at world coordinates
+template <class CellCost, class PathCost>
+point BasicCostMap<CellCost, PathCost>::to_window(point world) {
+    return {world.x - origin_x, world.y - origin_y};
+}
+
+// world coordinates of a map cell
+template <class CellCost, class PathCost>
+point BasicCostMap<CellCost, PathCost>::to_world(point p) {
+    return {p.x + origin_x, p.y + origin_y};
+}
+
+// store the cell costs as a scrolling ring
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::make_ring() {
+    int n = width * height;
+    aligned_vector<CellCost> new_costs(2 * n);
+    std::copy(cell_costs, cell_costs + n, new_costs.begin());
+    std::copy(cell_costs, cell_costs + n, new_costs.begin() + n);
+    cell_storage.swap(new_costs);
+    cell_costs = cell_storage.data();
+    map_file.close();
+    ring = true;
+}
+
+// set the cost of cell c in both copies of the ring
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::set_ring_cost(int c, CellCost cost) {
+    int n = width * height;
+    int i = cell_costs - cell_storage.data() + c;
+    cell_storage[i] = cost;
+    cell_storage[i < n ? i + n : i - n] = cost;
 }
 
 // add n > 0 or remove -n > 0 rows to/from the top side of the cost map
-void CostMap::reshape_top(int n) {
-    updated_since_astar = true;
-    if (n > 0)
-        for (int i = 0; i < width; i++)
-            cell_costs[i].insert(cell_costs[i].begin(), n, min);
-    else if (n < 0)
-        for (int i = 0; i < width; i++)
-            cell_costs[i].erase(cell_costs[i].begin(), cell_costs[i].begin() - n);
-    else return;
-    height += n;
-    for (int i = 0; i < width; i++)
-        astar_data[i].resize(height);
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::reshape_top(int n) {
+    if (n == 0) return;
+    map_version++;
+    reshape(n, 0, 0, 0);
 }
 
 // add n > 0 or remove -n > 0 rows to/from the bottom side of the cost map
-void CostMap::reshape_bottom(int n) {
-    updated_since_astar = true;
-    if (n > 0)
-        for (int i = 0; i < width; i++)
-            cell_costs[i].insert(cell_costs[i].end(), n, min);
-    else if (n < 0)
-        for (int i = 0; i < width; i++)
-            cell_costs[i].erase(cell_costs[i].end() + n, cell_costs[i].end());
-    else return;
-    height += n;
-    for (int i = 0; i < width; i++)
-        astar_data[i].resize(height);
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::reshape_bottom(int n) {
+    if (n == 0) return;
+    map_version++;
+    reshape(0, n, 0, 0);
 }
 
 // add n > 0 or remove -n > 0 columns to/from the left side of the cost map
-void CostMap::reshape_left(int n) {
-    updated_since_astar = true;
-    if (n > 0)
-        cell_costs.insert(cell_costs.begin(), n, deque<double>(height, min));
-    else if (n < 0)
-        cell_costs.erase(cell_costs.begin(), cell_costs.begin() - n);
-    else return;
-    width += n;
-    astar_data.resize(width);
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::reshape_left(int n) {
+    if (n == 0) return;
+    map_version++;
+    reshape(0, 0, n, 0);
 }
 
 // add n > 0 or remove -n > 0 columns to/from the right side of the cost map
-void CostMap::reshape_right(int n) {
-    updated_since_astar = true;
-    if (n > 0)
-        cell_costs.insert(cell_costs.end(), n, deque<double>(height, min));
-    else if (n < 0)
-        cell_costs.erase(cell_costs.end() + n, cell_costs.end());
-    else return;
-    width += n;
-    astar_data.resize(width);
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::reshape_right(int n) {
+    if (n == 0) return;
+    map_version++;
+    reshape(0, 0, 0, n);
 }
 
 // ----- A* -----
 
 // destination of travel
-point CostMap::get_goal() {
+template <class CellCost, class PathCost>
+point BasicCostMap<CellCost, PathCost>::get_goal() {
     return goal;
 }
 
-// cumulative cost of the minimum path to point p
-double CostMap::get_path_cost(point p) {
-    return astar_data[p.x][p.y].path_cost;
+// number of changes made to the map so far
+template <class CellCost, class PathCost>
+unsigned long long BasicCostMap<CellCost, PathCost>::get_map_version() {
+    return map_version;
 }
 
-// minimum cost of path between two points
-double CostMap::heuristic(point p1, point p2) {
-    double h;
+// cumulative cost of the minimum path to point p; after a path from the cache or D* Lite, only the cells of the path have a cost
+template <class CellCost, class PathCost>
+PathCost BasicCostMap<CellCost, PathCost>::get_path_cost(point p) {
+    if (tiles.is_open()) {
+        TileSearch* t = current_tile_data(p.x, p.y);
+        return t ? t->path_cost[tile_offset(p.x, p.y)] : std::numeric_limits<PathCost>::max();
+    }
+    int c = cell_index(p);
+    AstarData<PathCost>& data = context.astar_data;
+    return data.current(c) ? data.path_cost[c] : std::numeric_limits<PathCost>::max();
+}
+
+// memory allocated for the search data of find_path, forward and backward
+template <class CellCost, class PathCost>
+size_t BasicCostMap<CellCost, PathCost>::search_bytes() {
+    return context.astar_data.bytes() + context.astar_data_back.bytes();
+}
+
+// minimum cost of path between two points, with the heuristic of heuristic_type
+template <class CellCost, class PathCost>
+double BasicCostMap<CellCost, PathCost>::heuristic(point p1, point p2) {
     switch (heuristic_type) {
         case 'm':
-            h = abs(p1.x - p2.x) + abs(p1.y - p2.y); // Manhattan distance, tends to overestimate true minimum: _|
-            break;
+            return estimate<Manhattan>(p1, p2);
         case 'c':
-            h = std::max(abs(p1.x - p2.x), abs(p1.y - p2.y)); // Chebychev distance, tends to underestimate true minimum: |
-            break;
+            return estimate<Chebyshev>(p1, p2);
+        case 'o':
+            return estimate<Octile>(p1, p2);
+        case 'l': // the landmark bounds are only used inside the searches that can use them (see use_landmarks)
         case 'e':
-            h = sqrt(pow(p1.x - p2.x, 2) + pow(p1.y - p2.y, 2)); // Euclidean distance, true minimum: /
-            break;
         default:
-            h = sqrt(pow(p1.x - p2.x, 2) + pow(p1.y - p2.y, 2)); // Euclidean distance
+            return estimate<Euclidean>(p1, p2);
+    }
+}
+
+// minimum cost of path between two points, with the given heuristic
+template <class CellCost, class PathCost>
+template <class Heuristic>
+double BasicCostMap<CellCost, PathCost>::estimate(point p1, point p2) {
+    if constexpr (std::is_same_v<Heuristic, Landmarks>) return landmark_bound(cell_index(p1), cell_index(p2));
+    else return Heuristic::distance(abs(p1.x - p2.x), abs(p1.y - p2.y));
+}
+
+// index of a cell, y * width + x, as used by cell_costs, the search data, open lists and the path cache
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::cell_index(point p) {
+    return p.y * width + p.x;
+}
+
+// cell with the given index
+template <class CellCost, class PathCost>
+point BasicCostMap<CellCost, PathCost>::cell_point(int c) {
+    return {c % width, c / width};
+}
+
+// open list entry of a cell with its current path cost
+template <class CellCost, class PathCost>
+template <class Heuristic>
+OpenEntry BasicCostMap<CellCost, PathCost>::open_entry(SearchContext<PathCost>& ctx, int c) {
+    double g = ctx.astar_data.path_cost[c];
+    return {g + ctx.weight * estimate<Heuristic>(cell_point(c), ctx.goal), g, c};
+}
+
+// prepare for next astar path search, with open lists of the given type
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::reset_astar(SearchContext<PathCost>& ctx, char type) {
+    begin_search(ctx.astar_data);
+    // create the open lists if the requested implementation changed
+    if (!ctx.border || ctx.border_type != type) {
+        ctx.border.reset(make_open_list(type));
+        ctx.border_back.reset(make_open_list(type));
+        ctx.border_type = type;
+    }
+    ctx.border->clear(width * height);
+    ctx.path.clear();
+    ctx.waypoints.clear();
+    ctx.expansions = 0;
+    ctx.weight = 1;
+    ctx.suboptimality = 1;
+    STATS(ctx.stats = SearchStats());
+}
+
+// start a new search id, clearing the search data if the map was reshaped or the id wrapped
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::begin_search(AstarData<PathCost>& data) {
+    // a new search id makes the data of every cell stale, so blocks of cells are only reset when the search reaches them
+    data.id++;
+    if (data.cell_data.size() != (size_t)width * height || data.id == 0) {
+        data.path_cost.resize(width * height);
+        data.cell_data.resize(width * height);
+        data.block_id.assign((width * height + AstarData<PathCost>::BLOCK_SIZE - 1) / AstarData<PathCost>::BLOCK_SIZE, 0);
+        data.id = 1;
+    }
+}
+
+// open list type of a search, with the bucket queue of 'd' only if the search has integer keys and costs
+template <class CellCost, class PathCost>
+char BasicCostMap<CellCost, PathCost>::list_type(bool integer_keys) {
+    if (open_list_type == 'd' && !(integer_keys && integer_costs())) return 'b';
+    return open_list_type;
+}
+
+// create an empty open list of the given type
+template <class CellCost, class PathCost>
+OpenList* BasicCostMap<CellCost, PathCost>::make_open_list(char type) {
+    switch (type) {
+        case 'd':
+            return new BucketQueue();
+        case 'q':
+            return new DaryHeap(4);
+        case 'p':
+            return new PairingHeap();
+        case 'b':
+        default:
+            return new DaryHeap(2);
     }
-    return h;
 }
 
-// prepare for next astar path search
-void CostMap::reset_astar() {
-    for (int i = 0; i < width; i++)
-	    for (int j = 0; j < height; j++)
-	        astar_data[i][j] = CellAstarData();
-    border.clear();
-    path.clear();
-    waypoints.clear();
+// cost of a move of the given length into a cell of the given cost
+template <class CellCost, class PathCost>
+PathCost BasicCostMap<CellCost, PathCost>::move_cost(CellCost cost, double length) {
+    // moves of length 1 (all moves of integer path costs) skip the conversion to floating point
+    if (length == 1) return cost;
+    return cost * length;
+}
+
+// reset the search data of a cell, with its block, if it is stale, before it is used in the current search
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::touch(AstarData<PathCost>& data, int c) {
+    if (!data.current(c)) data.reset(c);
 }
 
 // update attributes of neighboring cells (based on current cell attributes)
-void CostMap::update_neighbors() {
-    vector<point> sides{4};
-    sides[0] = {this, cur_pt.x, cur_pt.y + 1};
-    sides[1] = {this, cur_pt.x, cur_pt.y - 1};
-    sides[2] = {this, cur_pt.x + 1, cur_pt.y};
-    sides[3] = {this, cur_pt.x - 1, cur_pt.y};
-    double new_cost;
-    for (point side : sides) {
-        if (!in_bounds(side)) continue;
+template <class CellCost, class PathCost>
+template <class Heuristic, class Neighborhood, class Observer>
+void BasicCostMap<CellCost, PathCost>::update_neighbors(SearchContext<PathCost>& ctx, Observer& obs) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    int cur_cell = ctx.cur_cell;
+    int x = cur_cell % width;
+    int y = cur_cell / width;
+    PathCost cur_cost = astar_data.path_cost[cur_cell];
+    for (int i = 0; i < Neighborhood::count; i++) {
+        int nx = x + Neighborhood::dx[i], ny = y + Neighborhood::dy[i];
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+        int side = ny * width + nx;
+        touch(astar_data, side);
         // update cost if new is less than existing
-        new_cost = astar_data[cur_pt.x][cur_pt.y].path_cost + cell_costs[side.x][side.y];
-        if (new_cost < astar_data[side.x][side.y].path_cost) {
-            astar_data[side.x][side.y].path_cost = new_cost;
-            astar_data[side.x][side.y].prev = cur_pt;
-            // push to border if not added already
-            if (!astar_data[side.x][side.y].added) {
-                border.push_back({this, side.x, side.y});
-                std::push_heap(border.begin(), border.end(), cheaper());
-                astar_data[side.x][side.y].added = true;
-            }
+        PathCost new_cost = cur_cost + move_cost(cell_costs[side], Neighborhood::length[i]);
+        if (new_cost < astar_data.path_cost[side]) {
+            relax<Heuristic>(ctx, side, i, new_cost);
+            obs.on_relax(*this, cell_point(side), new_cost);
         }
     }
 }
 
+// lower the path cost of cell c to new_cost via the given move into it, and add it to or move it up in the border
+template <class CellCost, class PathCost>
+template <class Heuristic>
+void BasicCostMap<CellCost, PathCost>::relax(SearchContext<PathCost>& ctx, int c, int move, PathCost new_cost) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    astar_data.path_cost[c] = new_cost;
+    astar_data.set_move(c, move);
+    STATS(ctx.stats.relaxed++);
+    // push to border if not added already, otherwise move it up in the border
+    if (astar_data.state(c) != 1) {
+        STATS(if (astar_data.state(c) == 2) ctx.stats.reopened++);
+        ctx.border->push(open_entry<Heuristic>(ctx, c));
+        astar_data.set_state(c, 1);
+        STATS(ctx.stats.pushes++; ctx.stats.max_open = std::max(ctx.stats.max_open, ctx.border->size()));
+    }
+    else {
+        ctx.border->decrease_key(open_entry<Heuristic>(ctx, c));
+        STATS(ctx.stats.decreases++);
+    }
+}
+
+// previous cell of cell c in its minimum path, or -1 at the start of the path
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::prev_cell(AstarData<PathCost>& data, int c) {
+    unsigned m = data.move(c);
+    if (m == AstarData<PathCost>::NO_MOVE) return -1;
+    return c - EightConnected::dy[m] * width - EightConnected::dx[m];
+}
+
+// move from cell from into its neighbor to, as an index into EightConnected
+template <class CellCost, class PathCost>
+unsigned BasicCostMap<CellCost, PathCost>::move_between(int from, int to) {
+    int dx = to % width - from % width, dy = to / width - from / width;
+    unsigned m = 0;
+    while (EightConnected::dx[m] != dx || EightConnected::dy[m] != dy)
+        m++;
+    return m;
+}
+
 // find waypoints in the path, for smooth movement
-void CostMap::find_waypoints() {
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::find_waypoints(SearchContext<PathCost>& ctx) {
+    deque<point>& path = ctx.path;
+    deque<point>& waypoints = ctx.waypoints;
     if (path.empty()) return;
-    point prev_dir = {this, 0, 0}; // direction of the previous path segment
-    point cur_dir = {this, 0, 0}; // direction of the current path segment
-    point prev_slope = {this, 0, 0}; // slope of the previous group of path segments
-    point cur_slope = {this, 0, 0}; // slope of the current group of path segments
+    point prev_dir = {0, 0}; // direction of the previous path segment
+    point cur_dir = {0, 0}; // direction of the current path segment
+    point prev_slope = {0, 0}; // slope of the previous group of path segments
+    point cur_slope = {0, 0}; // slope of the current group of path segments
     int wp_candidate = 0; // potential waypoint
     for (int i = 1; i < path.size(); i++) {
         // update current direction and slope
@@ -299,94 +933,1700 @@ void CostMap::find_waypoints() {
     waypoints.push_back(path.back()); // the end of the path is the last waypoint
 }
 
+// expand the border until the goal is reached
+template <class CellCost, class PathCost>
+template <class Heuristic, class Neighborhood, class Observer>
+void BasicCostMap<CellCost, PathCost>::expand_border(SearchContext<PathCost>& ctx, Observer& obs) {
+    int end = cell_index(ctx.goal);
+    bool jumping = search_type == 'j' || search_type == 'p';
+    bool any_angle = search_type == 't';
+    while (ctx.border->top().cell != end) {
+        ctx.cur_cell = ctx.border->pop().cell; // go to point with the lowest cost, and remove it from border
+        STATS(ctx.stats.pops++);
+        ctx.astar_data.set_state(ctx.cur_cell, 2);
+        ctx.expansions++;
+        obs.on_expand(*this, cell_point(ctx.cur_cell));
+        // update costs and add to border (or move up in border) as needed
+        if (jumping) update_jump_points<Heuristic>(ctx, obs);
+        else if (any_angle) update_any_angle<Heuristic, Neighborhood>(ctx, obs);
+        else update_neighbors<Heuristic, Neighborhood>(ctx, obs);
+    }
+}
+
+// find the path and waypoints from start to g, with the heuristic of heuristic_type
+template <class CellCost, class PathCost>
+template <class Observer>
+void BasicCostMap<CellCost, PathCost>::search(SearchContext<PathCost>& ctx, point start, point g, Observer& obs) {
+    switch (heuristic_type) {
+        case 'm':
+            return search_connected<Manhattan>(ctx, start, g, obs);
+        case 'c':
+            return search_connected<Chebyshev>(ctx, start, g, obs);
+        case 'o':
+            return search_connected<Octile>(ctx, start, g, obs);
+        case 'l':
+            if (use_landmarks()) return search_connected<Landmarks>(ctx, start, g, obs);
+            [[fallthrough]];
+        case 'e':
+        default:
+            return search_connected<Euclidean>(ctx, start, g, obs);
+    }
+}
+
+// find the path and waypoints from start to g, with the neighborhood of connectivity
+template <class CellCost, class PathCost>
+template <class Heuristic, class Observer>
+void BasicCostMap<CellCost, PathCost>::search_connected(SearchContext<PathCost>& ctx, point start, point g, Observer& obs) {
+    bool eight = connectivity == 8 && search_type != 'j' && search_type != 'p'; // jumps only work on the 4-connected grid
+    if constexpr (std::is_integral_v<PathCost>) {
+        if (eight || search_type == 't') {
+            cout << "error: diagonal moves and any-angle lines need floating-point path costs\n";
+            exit(1);
+        }
+    }
+    // Manhattan distance overestimates diagonal moves, so 8-connected searches use octile distance instead
+    if constexpr (std::is_same_v<Heuristic, Manhattan>) {
+        if (eight) return search_with<Octile, EightConnected>(ctx, start, g, obs);
+    }
+    if (eight) search_with<Heuristic, EightConnected>(ctx, start, g, obs);
+    else search_with<Heuristic, FourConnected>(ctx, start, g, obs);
+}
+
+// find the path and waypoints from start to g with the given heuristic and neighborhood
+template <class CellCost, class PathCost>
+template <class Heuristic, class Neighborhood, class Observer>
+void BasicCostMap<CellCost, PathCost>::search_with(SearchContext<PathCost>& ctx, point start_pt, point g, Observer& obs) {
+    STATS(auto t0 = std::chrono::steady_clock::now());
+    // f is an integer if the moves and the heuristic distances are; the keys of the bidirectional search are halves, and
+    // those of ARA* have a weighted heuristic
+    bool integer_keys = (std::is_same_v<Heuristic, Manhattan> || std::is_same_v<Heuristic, Chebyshev>) && std::is_same_v<Neighborhood, FourConnected>
+                        && search_type != 'b' && search_type != 't' && search_type != 'r';
+    reset_astar(ctx, list_type(integer_keys));
+    ctx.start = start_pt;
+    ctx.goal = g;
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    int start = cell_index(start_pt);
+    // set first border cell to starting point
+    touch(astar_data, start);
+    astar_data.path_cost[start] = 0;
+    astar_data.set_state(start, 1);
+    if (search_type == 't') {
+        astar_data.parent.resize(width * height);
+        astar_data.parent[start] = -1;
+    }
+    ctx.border->push(open_entry<Heuristic>(ctx, start));
+    STATS(ctx.stats.pushes++; ctx.stats.max_open = 1);
+    STATS(ctx.stats.reset_ms = elapsed_ms(t0); t0 = std::chrono::steady_clock::now());
+    if (search_type == 'b') {
+        // the bidirectional search reconstructs the path itself
+        expand_bidirectional<Heuristic, Neighborhood>(ctx, obs);
+        STATS(ctx.stats.search_ms = elapsed_ms(t0); t0 = std::chrono::steady_clock::now());
+        find_waypoints(ctx);
+        STATS(ctx.stats.waypoints_ms = elapsed_ms(t0));
+        STATS(ctx.stats.expanded = ctx.expansions; ctx.stats.path_length = ctx.path.size());
+        return;
+    }
+    if (search_type == 'r') {
+        // the anytime search traces the path of each of its iterations
+        expand_anytime<Heuristic, Neighborhood>(ctx, obs);
+        STATS(ctx.stats.search_ms = elapsed_ms(t0); t0 = std::chrono::steady_clock::now());
+        sum_path_costs(ctx);
+        STATS(ctx.stats.reconstruct_ms = elapsed_ms(t0); t0 = std::chrono::steady_clock::now());
+        find_waypoints(ctx);
+        STATS(ctx.stats.waypoints_ms = elapsed_ms(t0));
+        STATS(ctx.stats.expanded = ctx.expansions; ctx.stats.path_length = ctx.path.size());
+        return;
+    }
+    // expand border until goal is reached
+    expand_border<Heuristic, Neighborhood>(ctx, obs);
+    STATS(ctx.stats.search_ms = elapsed_ms(t0); t0 = std::chrono::steady_clock::now());
+    if (search_type == 't') {
+        // the corners of an any-angle path are its waypoints
+        any_angle_path(ctx);
+        ctx.suboptimality = std::numeric_limits<double>::infinity();
+        STATS(ctx.stats.reconstruct_ms = elapsed_ms(t0));
+        STATS(ctx.stats.expanded = ctx.expansions; ctx.stats.path_length = ctx.path.size());
+        return;
+    }
+    trace_path(ctx);
+    STATS(ctx.stats.reconstruct_ms = elapsed_ms(t0); t0 = std::chrono::steady_clock::now());
+    find_waypoints(ctx);
+    STATS(ctx.stats.waypoints_ms = elapsed_ms(t0));
+    STATS(ctx.stats.expanded = ctx.expansions; ctx.stats.path_length = ctx.path.size());
+}
+
+// set the path from the moves of the cells, from the goal back to the start
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::trace_path(SearchContext<PathCost>& ctx) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    int start = cell_index(ctx.start);
+    int end = cell_index(ctx.goal);
+    astar_data.set_state(end, 2);
+    bool jumping = search_type == 'j' || search_type == 'p';
+    for (int c = end, prev; c != start; c = prev) {
+        // consecutive cells of the path are neighbors, except after jumps, which skip over a straight line of uniform cells
+        prev = jumping ? jump_origin(astar_data, c) : prev_cell(astar_data, c);
+        int step = c / width == prev / width ? (c > prev ? 1 : -1) : (c > prev ? width : -width);
+        ctx.path.push_front(cell_point(c));
+        for (int m = c - step; jumping && m != prev; m -= step) {
+            touch(astar_data, m);
+            astar_data.path_cost[m] = astar_data.path_cost[prev] + (PathCost)((m - prev) / step) * min;
+            ctx.path.push_front(cell_point(m));
+        }
+    }
+    ctx.path.push_front(cell_point(start));
+}
+
 // find the optimal path to a goal g using the A* algorithm
-deque<point> CostMap::find_path(point g) {
+template <class CellCost, class PathCost>
+deque<point> BasicCostMap<CellCost, PathCost>::find_path(point g) {
     // check that g is in bounds and set the goal
     if (!in_bounds(g)) return path;
     goal = g;
-    // if map hasn't changed since last run, results will be the same; otherwise, reset and start over
-    if (!updated_since_astar) return path;
-    reset_astar();
-    // set first border cell to starting point
-    astar_data[pos.x][pos.y].path_cost = 0;
-    astar_data[pos.x][pos.y].visited = true;
-    astar_data[pos.x][pos.y].added = true;
-    border.push_back(pos);
-    // almost last spot before A* uses cost map (i.e. last spot when A* is guaranteed to be relying on up-to-date data)
-    updated_since_astar = false;
-    // expand border until goal is reached
-    while (border[0].x != goal.x || border[0].y != goal.y) {
-        cur_pt = border[0]; // go to point with the lowest cost
-        astar_data[cur_pt.x][cur_pt.y].visited = true;
-        std::pop_heap(border.begin(), border.end(), cheaper());
-        border.pop_back(); // remove current point from border
-        astar_data[cur_pt.x][cur_pt.y].added = false;
-        update_neighbors(); // update costs and add to border as needed
-        std::make_heap(border.begin(), border.end(), cheaper()); // update border in case element costs updated
+    STATS(auto started = std::chrono::steady_clock::now(); stats = SearchStats());
+    NoObserver none;
+    if (tiles.is_open()) {
+        // only A* can search a tiled map
+        if (observer) find_path_tiled(pos, goal, *observer);
+        else find_path_tiled(pos, goal, none);
+        suboptimality = 1;
+        if (observer) observer->on_path_found(*this, path);
     }
-    // reconstruct path from end to beginning
-    cur_pt = goal;
-    astar_data[cur_pt.x][cur_pt.y].visited = true;
-    while (cur_pt.x != pos.x || cur_pt.y != pos.y) {
-        path.push_front(cur_pt);
-        cur_pt = astar_data[cur_pt.x][cur_pt.y].prev;
-    }
-    path.push_front(cur_pt);
-    find_waypoints();
-    print_cell_cost_map();
-    print_path_cost_map();
-    print_search_map();
-    print_path();
+    else if (search_type == 'd') {
+        if (observer) find_path_incremental(*observer);
+        else find_path_incremental(none);
+        suboptimality = 1;
+    }
+    else if (search_type == 'h') {
+        dstar_valid = false; // changes to the map are not tracked while other searches are used
+        // HPA* paths are not always minimal, so they are kept out of the cache
+        if (observer) find_path_hierarchical(*observer);
+        else find_path_hierarchical(none);
+        suboptimality = std::numeric_limits<double>::infinity();
+    }
+    else find_path_cached();
+    // time not covered by the split of the search (cache lookups, and engines without a split) counts as search time
+    STATS(stats.search_ms += elapsed_ms(started) - stats.reset_ms - stats.search_ms - stats.reconstruct_ms - stats.waypoints_ms);
+    STATS(stats.expanded = expansions; stats.path_length = path.size());
+    STATS(histogram.add(stats));
+    return waypoints;
+}
+
+// find the path to goal with the engine of search_type, or reuse it from the cache
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::find_path_cached() {
+    NoObserver none;
+    dstar_valid = false; // changes to the map are not tracked while other searches are used
+    // the minimum paths of one neighborhood are not minimal in the other
+    int paths_connectivity = connectivity == 8 && search_type != 'j' && search_type != 'p' ? 8 : 4;
+    if (paths_connectivity != cache_connectivity) {
+        cache.clear();
+        cache_connectivity = paths_connectivity;
+    }
+    // any-angle paths are not grid paths, so they are kept out of the cache
+    bool cached = search_type != 't';
+    // reuse a path from the same map if one is known; otherwise, search and remember the result
+    if (cached && cache.lookup(cell_index(pos), cell_index(goal), map_version, cache_cells)) {
+        load_path(cache_cells);
+        expansions = 0;
+        suboptimality = 1;
+    }
+    else {
+        if (search_type == 'p' && jump_dist_stale) build_jump_dist();
+        if (observer) search(context, pos, goal, *observer);
+        else search(context, pos, goal, none);
+        path.swap(context.path);
+        waypoints.swap(context.waypoints);
+        expansions = context.expansions;
+        suboptimality = context.suboptimality;
+        STATS(stats = context.stats);
+        // the cache only holds minimum paths, which an ARA* search cut short may not have found
+        if (cached && suboptimality == 1) {
+            cache_cells.clear();
+            for (point pt : path)
+                cache_cells.push_back(cell_index(pt));
+            cache.insert(cache_cells, map_version);
+        }
+    }
+    if (observer) observer->on_path_found(*this, path);
+}
+
+// set path and waypoints to a known minimum path, with its path costs
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::load_path(const vector<int>& cells) {
+    AstarData<PathCost>& data = context.astar_data;
+    begin_search(data);
+    context.path.clear();
+    context.waypoints.clear();
+    for (int i = 0; i < (int)cells.size(); i++) {
+        int c = cells[i];
+        touch(data, c);
+        int from = i == 0 ? -1 : cells[i - 1];
+        bool diagonal = from >= 0 && from % width != c % width && from / width != c / width;
+        data.path_cost[c] = from < 0 ? 0 : data.path_cost[from] + move_cost(cell_costs[c], diagonal ? DIAGONAL : 1);
+        if (from >= 0) data.set_move(c, move_between(from, c));
+        data.set_state(c, 2);
+        context.path.push_back(cell_point(c));
+    }
+    find_waypoints(context);
+    path.swap(context.path);
+    waypoints.swap(context.waypoints);
+}
+
+// find the waypoints of many paths in parallel; queries with a start or goal outside the map get no waypoints.
+// The map must not be changed until find_paths returns; observer and cache are not used, and D* Lite and HPA* queries, and
+// all queries of a tiled map, use A* (see search_type).
+template <class CellCost, class PathCost>
+vector<deque<point>> BasicCostMap<CellCost, PathCost>::find_paths(std::span<const query> queries, int threads) {
+    vector<deque<point>> results(queries.size());
+    if (tiles.is_open()) {
+        // the tile cache is not thread-safe, so the queries of a tiled map run one after another; they leave the path and
+        // waypoints of find_path as they were
+        NoObserver none;
+        deque<point> saved_path, saved_waypoints;
+        path.swap(saved_path);
+        waypoints.swap(saved_waypoints);
+        for (size_t i = 0; i < queries.size(); i++)
+            if (in_bounds(queries[i].start) && in_bounds(queries[i].goal)) {
+                find_path_tiled(queries[i].start, queries[i].goal, none);
+                results[i].swap(waypoints);
+            }
+        path.swap(saved_path);
+        waypoints.swap(saved_waypoints);
+        return results;
+    }
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    // data shared by all searches has to be ready before they start
+    if (search_type == 'p' && jump_dist_stale) build_jump_dist();
+    integer_costs();
+    if (!pool || pool->size() != threads) {
+        pool.reset(new WorkStealingPool(threads));
+        worker_contexts.clear();
+        worker_contexts.resize(threads);
+    }
+    STATS(vector<SearchStats> query_stats(queries.size()));
+    pool->run(queries.size(), [&](int worker, int i) {
+        const query& q = queries[i];
+        if (!in_bounds(q.start) || !in_bounds(q.goal)) return;
+        NoObserver none;
+        search(worker_contexts[worker], q.start, q.goal, none);
+        results[i].swap(worker_contexts[worker].waypoints);
+        STATS(query_stats[i] = worker_contexts[worker].stats);
+    });
+    STATS(for (SearchStats& s : query_stats) histogram.add(s));
+    return results;
+}
+
+// ----- JPS -----
+
+// Jump point search on the 4-connected grid. Between two cells of a region that only contains cells of the minimum cost,
+// every path that moves horizontally first and then vertically is optimal, so the search only adds cells to the border where
+// such a path may have to turn (jump points) and skips over the straight lines in between. Non-uniform cells and the cells
+// next to them are always jump points and have all their neighbors updated, so the path cost is the same as with A*.
+
+// whether a cell is in the map and has the minimum cost
+template <class CellCost, class PathCost>
+bool BasicCostMap<CellCost, PathCost>::is_uniform(int x, int y) {
+    return 0 <= x && x < width && 0 <= y && y < height && cell_costs[y * width + x] == min;
+}
+
+// whether a cell is non-uniform or next to a non-uniform cell, so every jump stops at it
+template <class CellCost, class PathCost>
+bool BasicCostMap<CellCost, PathCost>::is_jump_stop(int x, int y) {
+    if (!is_uniform(x, y)) return true;
+    for (int d = 0; d < 4; d++) {
+        int nx = x + FourConnected::dx[d], ny = y + FourConnected::dy[d];
+        if (0 <= nx && nx < width && 0 <= ny && ny < height && cell_costs[ny * width + nx] != min) return true;
+    }
+    return false;
+}
+
+// whether a vertical jump moving in direction dy must stop at a cell to turn sideways: a side neighbor is uniform, but the
+// cell behind it is not, so no horizontal-first path reaches the side neighbor without passing this cell
+template <class CellCost, class PathCost>
+bool BasicCostMap<CellCost, PathCost>::has_forced_neighbor(int x, int y, int dy) {
+    for (int dx = -1; dx <= 1; dx += 2)
+        if (is_uniform(x + dx, y) && !is_uniform(x + dx, y - dy)) return true;
+    return false;
+}
+
+// jump by scanning the map cell by cell, ignoring the goal
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::scan(int c, int dir, int& steps) {
+    int x = c % width, y = c / width;
+    for (steps = 1; ; steps++) {
+        x += FourConnected::dx[dir];
+        y += FourConnected::dy[dir];
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+            steps = 1 - steps; // minus the steps to the edge of the map
+            return -1;
+        }
+        if (is_jump_stop(x, y)) return y * width + x;
+        if (FourConnected::dx[dir] != 0) {
+            // a horizontal jump stops where a path can turn vertically towards a jump point
+            int s;
+            if (scan(y * width + x, 0, s) >= 0 || scan(y * width + x, 1, s) >= 0) return y * width + x;
+        }
+        else if (has_forced_neighbor(x, y, FourConnected::dy[dir])) return y * width + x;
+    }
+}
+
+// jump from cell c in direction dir; return the jump point reached and the steps taken, or -1
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::jump(SearchContext<PathCost>& ctx, int c, int dir, int& steps) {
+    point goal = ctx.goal;
+    int x = c % width, y = c / width;
+    int jp;
+    int reach; // steps to the jump point or the edge of the map
+    if (search_type == 'p') {
+        int d = jump_dist[c * 4 + dir];
+        jp = d > 0 ? c + d * (FourConnected::dx[dir] + FourConnected::dy[dir] * width) : -1;
+        reach = std::abs(d);
+    }
+    else {
+        jp = scan(c, dir, reach);
+        reach = std::abs(reach);
+    }
+    steps = reach;
+    // stop at the goal if it is on the line of the jump, before the jump point
+    int goal_steps = (goal.x - x) * FourConnected::dx[dir] + (goal.y - y) * FourConnected::dy[dir];
+    if (goal_steps <= 0 || goal_steps > reach) return jp;
+    if (FourConnected::dx[dir] ? goal.y == y : goal.x == x) {
+        steps = goal_steps;
+        return cell_index(goal);
+    }
+    // a horizontal jump also stops in the column of the goal if a vertical jump from there reaches the goal
+    if (FourConnected::dx[dir] && (goal_steps < reach || jp < 0)) {
+        int m = y * width + goal.x;
+        int vdir = goal.y > y ? 0 : 1;
+        int vreach;
+        if (search_type == 'p') vreach = std::abs(jump_dist[m * 4 + vdir]);
+        else {
+            scan(m, vdir, vreach);
+            vreach = std::abs(vreach);
+        }
+        if (vreach >= std::abs(goal.y - y)) {
+            steps = goal_steps;
+            return m;
+        }
+    }
+    return jp;
+}
+
+// precompute the jump distances in every direction for JPS+
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::build_jump_dist() {
+    jump_dist.assign(width * height * 4, 0);
+    // the distance from a cell is one more than the distance from the next cell, unless the next cell is a jump point;
+    // vertical distances are needed first, since horizontal jumps stop where a vertical jump finds a jump point
+    for (int dir = 0; dir < 4; dir++) {
+        int dx = FourConnected::dx[dir], dy = FourConnected::dy[dir];
+        // visit cells so that the next cell in direction dir is always done first
+        for (int i = 0; i < width * height; i++) {
+            int x = dx > 0 ? width - 1 - i % width : i % width;
+            int y = dy > 0 ? height - 1 - i / width : i / width;
+            int nx = x + dx, ny = y + dy;
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            int n = ny * width + nx;
+            bool stop = is_jump_stop(nx, ny);
+            if (dx) stop = stop || jump_dist[n * 4 + 0] > 0 || jump_dist[n * 4 + 1] > 0;
+            else stop = stop || has_forced_neighbor(nx, ny, dy);
+            int next = jump_dist[n * 4 + dir];
+            jump_dist[(y * width + x) * 4 + dir] = stop ? 1 : (next > 0 ? next + 1 : next - 1);
+        }
+    }
+    jump_dist_stale = false;
+}
+
+// update attributes of the jump points reachable from the current cell
+template <class CellCost, class PathCost>
+template <class Heuristic, class Observer>
+void BasicCostMap<CellCost, PathCost>::update_jump_points(SearchContext<PathCost>& ctx, Observer& obs) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    int cur_cell = ctx.cur_cell;
+    int x = cur_cell % width, y = cur_cell / width;
+    unsigned dir = astar_data.move(cur_cell);
+    bool dirs[4] = {true, true, true, true};
+    // jump stops and the start update every direction; other cells continue the jump that reached them, and turn where a
+    // horizontal-first path can turn
+    if (dir != AstarData<PathCost>::NO_MOVE && !is_jump_stop(x, y)) {
+        dirs[dir ^ 1] = false; // never back
+        if (dir < 2) {
+            // vertical: straight on, and sideways only to forced neighbors
+            dirs[2] = is_uniform(x + 1, y) && !is_uniform(x + 1, y - FourConnected::dy[dir]);
+            dirs[3] = is_uniform(x - 1, y) && !is_uniform(x - 1, y - FourConnected::dy[dir]);
+        }
+    }
+    PathCost cur_cost = astar_data.path_cost[cur_cell];
+    for (int dir = 0; dir < 4; dir++) {
+        if (!dirs[dir]) continue;
+        int nx = x + FourConnected::dx[dir], ny = y + FourConnected::dy[dir];
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+        int steps = 1;
+        int jp = ny * width + nx;
+        // non-uniform neighbors are entered like in A*, uniform ones are jumped over
+        if (cell_costs[jp] == min) jp = jump(ctx, cur_cell, dir, steps);
+        if (jp < 0) continue;
+        touch(astar_data, jp);
+        PathCost new_cost = cur_cost + (PathCost)(steps - 1) * min + cell_costs[jp];
+        if (new_cost < astar_data.path_cost[jp]) {
+            relax<Heuristic>(ctx, jp, dir, new_cost);
+            obs.on_relax(*this, cell_point(jp), new_cost);
+        }
+    }
+}
+
+// cell that the jump into cell c was made from, or one with a path of the same cost. Only the direction of the jump is
+// kept, so the cells are walked back along it to the first one the search reached whose path cost, plus the cells
+// jumped over at min each, plus the cost of c, is at most the path cost of c.
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::jump_origin(AstarData<PathCost>& data, int c) {
+    unsigned m = data.move(c);
+    int step = EightConnected::dy[m] * width + EightConnected::dx[m];
+    for (int p = c - step, k = 0;; p -= step, k++)
+        if (data.current(p) && data.state(p) != 0 && data.path_cost[p] + (PathCost)k * min + cell_costs[c] <= data.path_cost[c])
+            return p;
+}
+
+// ----- BIDIRECTIONAL -----
+
+// Bidirectional A*: a forward search from pos and a backward search from the goal, each with its own search data and
+// border. Moving from a cell into a neighbor costs the neighbor's cost, so the backward search pays the cost of the cell it
+// moves out of, and a path through a cell m costs the forward path cost of m plus the backward path cost of m.
+// Both searches use the average of the two heuristics, p(c) = (heuristic(c, goal) - heuristic(c, pos)) / 2 forward and -p(c)
+// backward, so the search stops as soon as the cheapest border entries of both directions together cost at least as much
+// as the cheapest path found so far. Each search on its own then stops near the middle instead of crossing the other.
+
+// expand the forward and backward borders until the minimum path is found
+template <class CellCost, class PathCost>
+template <class Heuristic, class Neighborhood, class Observer>
+void BasicCostMap<CellCost, PathCost>::expand_bidirectional(SearchContext<PathCost>& ctx, Observer& obs) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    AstarData<PathCost>& astar_data_back = ctx.astar_data_back;
+    OpenList* border = ctx.border.get();
+    OpenList* border_back = ctx.border_back.get();
+    point pos = ctx.start;
+    point goal = ctx.goal;
+    int start = cell_index(pos);
+    int end = cell_index(goal);
+    begin_search(astar_data_back);
+    border_back->clear(width * height);
+    touch(astar_data_back, end);
+    astar_data_back.path_cost[end] = 0;
+    astar_data_back.set_state(end, 1);
+    border_back->push({(estimate<Heuristic>(goal, pos) - estimate<Heuristic>(goal, goal)) / 2, 0, end});
+    // the forward border was started with the plain heuristic
+    border->clear(width * height);
+    border->push({(estimate<Heuristic>(pos, goal) - estimate<Heuristic>(pos, pos)) / 2, 0, start});
+    STATS(ctx.stats.pushes += 2; ctx.stats.max_open = 2);
+    PathCost best = start == end ? 0 : std::numeric_limits<PathCost>::max(); // cost of the cheapest path found so far
+    int meet = start; // cell where that path joins the forward and backward searches
+    while (!border->empty() && !border_back->empty() && border->top().f + border_back->top().f < best) {
+        // expand the direction with the smaller border
+        bool forward = border->size() <= border_back->size();
+        AstarData<PathCost>& data = forward ? astar_data : astar_data_back;
+        AstarData<PathCost>& other = forward ? astar_data_back : astar_data;
+        OpenList& open = forward ? *border : *border_back;
+        int cur = open.pop().cell;
+        data.set_state(cur, 2);
+        ctx.expansions++;
+        STATS(ctx.stats.pops++);
+        obs.on_expand(*this, cell_point(cur));
+        int x = cur % width, y = cur / width;
+        for (int i = 0; i < Neighborhood::count; i++) {
+            int nx = x + Neighborhood::dx[i], ny = y + Neighborhood::dy[i];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            int side = ny * width + nx;
+            touch(data, side);
+            PathCost new_cost = data.path_cost[cur] + move_cost(forward ? cell_costs[side] : cell_costs[cur], Neighborhood::length[i]);
+            if (new_cost >= data.path_cost[side]) continue;
+            data.path_cost[side] = new_cost;
+            data.set_move(side, i);
+            if (forward) obs.on_relax(*this, cell_point(side), new_cost);
+            double potential = (estimate<Heuristic>(cell_point(side), goal) - estimate<Heuristic>(cell_point(side), pos)) / 2;
+            OpenEntry entry = {new_cost + (forward ? potential : -potential), (double)new_cost, side};
+            STATS(ctx.stats.relaxed++);
+            if (data.state(side) != 1) {
+                STATS(if (data.state(side) == 2) ctx.stats.reopened++);
+                open.push(entry);
+                data.set_state(side, 1);
+                STATS(ctx.stats.pushes++; ctx.stats.max_open = std::max(ctx.stats.max_open, border->size() + border_back->size()));
+            }
+            else {
+                open.decrease_key(entry);
+                STATS(ctx.stats.decreases++);
+            }
+            // the neighbor joins the two searches if the other one reached it too
+            if (other.current(side) && other.path_cost[side] != std::numeric_limits<PathCost>::max()
+                && new_cost + other.path_cost[side] < best) {
+                best = new_cost + other.path_cost[side];
+                meet = side;
+            }
+        }
+    }
+    // reconstruct path: forward from the meeting cell to pos, then backward from the meeting cell to the goal
+    for (int c = meet; c != start; c = prev_cell(astar_data, c))
+        ctx.path.push_front(cell_point(c));
+    ctx.path.push_front(pos);
+    PathCost meet_cost = astar_data.path_cost[meet];
+    for (int c = meet; c != end;) {
+        c = prev_cell(astar_data_back, c);
+        // record the forward path cost of the cells found by the backward search
+        touch(astar_data, c);
+        astar_data.path_cost[c] = meet_cost + astar_data_back.path_cost[meet] - astar_data_back.path_cost[c];
+        astar_data.set_state(c, 2);
+        ctx.path.push_back(cell_point(c));
+    }
+}
+
+// ----- THETA* -----
+
+// Theta* is A* where a cell may take its parent's parent as its own parent, if the straight line between them is cheaper
+// than the grid moves through the parent, so paths turn only where they have to and the parents of the goal are the
+// waypoints. A line pays for every cell it enters, except the one it starts in, at the cost of the most expensive of them
+// per unit of length; a line to a neighbor then costs the same as a move to it, and a line across uniform cells costs
+// their cost times its length. A line that touches the corner of two cells enters neither of them, like a diagonal move.
+
+// update neighboring cells with a move from the current cell or a line from its parent
+template <class CellCost, class PathCost>
+template <class Heuristic, class Neighborhood, class Observer>
+void BasicCostMap<CellCost, PathCost>::update_any_angle(SearchContext<PathCost>& ctx, Observer& obs) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    int cur_cell = ctx.cur_cell;
+    int x = cur_cell % width;
+    int y = cur_cell / width;
+    int parent = astar_data.parent[cur_cell];
+    PathCost cur_cost = astar_data.path_cost[cur_cell];
+    for (int i = 0; i < Neighborhood::count; i++) {
+        int nx = x + Neighborhood::dx[i], ny = y + Neighborhood::dy[i];
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+        int side = ny * width + nx;
+        if (side == parent) continue;
+        touch(astar_data, side);
+        int from = cur_cell;
+        PathCost new_cost = cur_cost + move_cost(cell_costs[side], Neighborhood::length[i]);
+        if (parent >= 0) {
+            // ties, up to rounding, go to the line, which saves a waypoint
+            PathCost through_parent = astar_data.path_cost[parent] + line_cost(parent, side);
+            if (through_parent <= new_cost * (1 + 1e-12)) {
+                from = parent;
+                new_cost = through_parent;
+            }
+        }
+        if (new_cost < astar_data.path_cost[side]) {
+            relax<Heuristic>(ctx, side, i, new_cost);
+            astar_data.parent[side] = from;
+            obs.on_relax(*this, cell_point(side), new_cost);
+        }
+    }
+}
+
+// call visit for each cell that the line from cell from to cell to enters, in order
+template <class CellCost, class PathCost>
+template <class Visit>
+void BasicCostMap<CellCost, PathCost>::trace_line(int from, int to, Visit visit) {
+    int x = from % width, y = from / width;
+    long long nx = std::abs(to % width - x), ny = std::abs(to / width - y);
+    int sx = to % width > x ? 1 : -1, sy = to / width > y ? 1 : -1;
+    // step to the next cell boundary the line crosses: (ix + 1/2) / nx is where the line leaves the column, and
+    // (iy + 1/2) / ny where it leaves the row
+    for (long long ix = 0, iy = 0; ix < nx || iy < ny;) {
+        long long next = (1 + 2 * ix) * ny - (1 + 2 * iy) * nx;
+        if (next <= 0) {
+            x += sx;
+            ix++;
+        }
+        if (next >= 0) {
+            y += sy;
+            iy++;
+        }
+        visit(y * width + x);
+    }
+}
+
+// cost of moving in a straight line from cell from to cell to
+template <class CellCost, class PathCost>
+PathCost BasicCostMap<CellCost, PathCost>::line_cost(int from, int to) {
+    CellCost highest = 0;
+    trace_line(from, to, [&](int c) { highest = std::max(highest, cell_costs[c]); });
+    return move_cost(highest, Euclidean::distance(std::abs(to % width - from % width), std::abs(to / width - from / width)));
+}
+
+// set the path and waypoints of an any-angle search from the parents of the goal
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::any_angle_path(SearchContext<PathCost>& ctx) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    int start = cell_index(ctx.start);
+    int end = cell_index(ctx.goal);
+    astar_data.set_state(end, 2);
+    vector<int> corners = {end};
+    while (corners.back() != start)
+        corners.push_back(astar_data.parent[corners.back()]);
+    ctx.path.push_back(ctx.start);
+    // at the goal already, the path and the waypoints are just the goal, as with the other engines
+    if (corners.size() == 1) ctx.waypoints.push_back(cell_point(end));
+    for (int k = corners.size() - 2; k >= 0; k--) {
+        int from = corners[k + 1], to = corners[k];
+        trace_line(from, to, [&](int m) { ctx.path.push_back(cell_point(m)); });
+        ctx.waypoints.push_back(cell_point(to));
+        // a parent whose cost went down after it was expanded leaves the cost of its children too high, so the costs of
+        // the corners are summed again along the path
+        astar_data.path_cost[to] = astar_data.path_cost[from] + line_cost(from, to);
+    }
+}
+
+// ----- ARA* -----
+
+// Anytime Repairing A* (Likhachev, Gordon and Thrun): A* with the heuristic multiplied by a weight w >= 1 expands far
+// fewer cells, and still finds a path that costs at most w times the minimum. ARA* starts with anytime_weight and then
+// lowers w by ANYTIME_WEIGHT_STEP at a time, each iteration continuing from the search data of the last: only the border
+// and the cells whose cost went down after the last iteration expanded them (inconsistent cells) are expanded again, with
+// the keys of the new weight. An iteration ends when no key is lower than the cost of the goal. Its path then costs at most
+// min(w, g(goal) / min(g + h)) times the minimum, over the cells still waiting for expansion, which is often well below w.
+// The iterations stop once the path is minimal (w = 1 or the bound is 1) or anytime_budget_ms has passed since the search
+// started; an iteration that runs out of time is dropped and the last path is kept. The heuristic has to be consistent for
+// the bound to hold, as Manhattan, octile and Euclidean distances are on grids of cell costs of at least 1.
+
+// expand the border with a weighted heuristic until a path is found, then improve it while lowering the weight
+template <class CellCost, class PathCost>
+template <class Heuristic, class Neighborhood, class Observer>
+void BasicCostMap<CellCost, PathCost>::expand_anytime(SearchContext<PathCost>& ctx, Observer& obs) {
+    auto started = std::chrono::steady_clock::now();
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    int end = cell_index(ctx.goal);
+    touch(astar_data, end);
+    ctx.closed.clear();
+    ctx.inconsistent.clear();
+    // the border only holds the start, so its key does not depend on the weight
+    ctx.weight = std::max(1.0, anytime_weight);
+    for (bool first = true; ; first = false) {
+        while (!ctx.border->empty() && astar_data.path_cost[end] > ctx.border->top().f) {
+            // the first path is always found; the clock is read every 64 expansions after that
+            if (!first && ctx.expansions % 64 == 0 && elapsed_ms(started) > anytime_budget_ms) return;
+            ctx.cur_cell = ctx.border->pop().cell;
+            STATS(ctx.stats.pops++);
+            astar_data.set_state(ctx.cur_cell, 2);
+            ctx.closed.push_back(ctx.cur_cell);
+            ctx.expansions++;
+            obs.on_expand(*this, cell_point(ctx.cur_cell));
+            update_anytime<Heuristic, Neighborhood>(ctx, obs);
+        }
+        ctx.path.clear();
+        trace_path(ctx);
+        // the cells of the next iteration: the inconsistent cells, and the border, which also bound the minimum cost
+        while (!ctx.border->empty())
+            ctx.inconsistent.push_back(ctx.border->pop().cell);
+        double goal_cost = astar_data.path_cost[end];
+        double lower = goal_cost;
+        for (int c : ctx.inconsistent)
+            lower = std::min(lower, astar_data.path_cost[c] + estimate<Heuristic>(cell_point(c), ctx.goal));
+        ctx.suboptimality = lower > 0 ? std::min(ctx.weight, goal_cost / lower) : 1; // lower is 0 only at the goal
+        if (ctx.suboptimality <= 1 || elapsed_ms(started) > anytime_budget_ms) {
+            ctx.suboptimality = std::max(1.0, ctx.suboptimality);
+            return;
+        }
+        // reopen the cells for the next iteration with the keys of the lower weight
+        ctx.weight = std::max(1.0, ctx.weight - ANYTIME_WEIGHT_STEP);
+        for (int c : ctx.closed)
+            if (astar_data.state(c) == 2) astar_data.set_state(c, 0);
+        for (int c : ctx.inconsistent) {
+            astar_data.set_state(c, 1);
+            ctx.border->push(open_entry<Heuristic>(ctx, c));
+        }
+        ctx.closed.clear();
+        ctx.inconsistent.clear();
+    }
+}
+
+// update neighboring cells, leaving cells expanded by this iteration for the next one
+template <class CellCost, class PathCost>
+template <class Heuristic, class Neighborhood, class Observer>
+void BasicCostMap<CellCost, PathCost>::update_anytime(SearchContext<PathCost>& ctx, Observer& obs) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    int cur_cell = ctx.cur_cell;
+    int x = cur_cell % width;
+    int y = cur_cell / width;
+    PathCost cur_cost = astar_data.path_cost[cur_cell];
+    for (int i = 0; i < Neighborhood::count; i++) {
+        int nx = x + Neighborhood::dx[i], ny = y + Neighborhood::dy[i];
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+        int side = ny * width + nx;
+        touch(astar_data, side);
+        PathCost new_cost = cur_cost + move_cost(cell_costs[side], Neighborhood::length[i]);
+        if (new_cost >= astar_data.path_cost[side]) continue;
+        if (astar_data.state(side) == 2 || astar_data.state(side) == ANYTIME_LOWERED) {
+            // an iteration expands each cell at most once, so the lower cost waits for the next iteration
+            astar_data.path_cost[side] = new_cost;
+            astar_data.set_move(side, i);
+            if (astar_data.state(side) == 2) ctx.inconsistent.push_back(side);
+            astar_data.set_state(side, ANYTIME_LOWERED);
+        }
+        else relax<Heuristic>(ctx, side, i, new_cost);
+        obs.on_relax(*this, cell_point(side), new_cost);
+    }
+}
+
+// set the path costs of the cells of the path to the costs of its moves: a cell whose cost went down after it was
+// expanded leaves the costs of the cells after it too high
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::sum_path_costs(SearchContext<PathCost>& ctx) {
+    AstarData<PathCost>& astar_data = ctx.astar_data;
+    for (int i = 1; i < (int)ctx.path.size(); i++) {
+        int from = cell_index(ctx.path[i - 1]), c = cell_index(ctx.path[i]);
+        bool diagonal = from % width != c % width && from / width != c / width;
+        astar_data.path_cost[c] = astar_data.path_cost[from] + move_cost(cell_costs[c], diagonal ? DIAGONAL : 1);
+        astar_data.set_move(c, move_between(from, c));
+        astar_data.set_state(c, 2);
+    }
+}
+
+// ----- D* LITE -----
+
+// D* Lite searches backward from the goal, so the g of a cell is the cost of the minimum path from the cell to the goal,
+// and moving from a cell into a neighbor costs the neighbor's cost. A cell is consistent when its g equals its rhs, the
+// minimum over its neighbors of the neighbor's cost plus the neighbor's g; only inconsistent cells are in the border.
+// When cell costs change, only the rhs of their neighbors is recomputed, and the search expands just the cells whose
+// minimum path changed. When pos moves, the heuristic distance it moved is added to km instead of re-keying the border.
+
+// find the optimal path to goal, reusing the previous search
+template <class CellCost, class PathCost>
+template <class Observer>
+deque<point> BasicCostMap<CellCost, PathCost>::find_path_incremental(Observer& obs) {
+    int start = cell_index(pos);
+    if (!dstar_valid || dstar_goal.x != goal.x || dstar_goal.y != goal.y || dstar_heuristic_type != heuristic_type || dstar_border_type != list_type(false))
+        dstar_reset();
+    else if (changed_cells.empty() && dstar_start.x == pos.x && dstar_start.y == pos.y) {
+        // nothing changed since the last search, so its path stands; the observer still hears about it like any search
+        expansions = 0;
+        if (observer) observer->on_path_found(*this, path);
+        return waypoints;
+    } else {
+        dstar_km += heuristic(dstar_start, pos);
+        dstar_start = pos;
+        // the cost of moving into a changed cell only affects the rhs of its neighbors
+        for (int c : changed_cells) {
+            int x = c % width, y = c / width;
+            for (int dir = 0; dir < 4; dir++) {
+                if (!in_bounds({x + FourConnected::dx[dir], y + FourConnected::dy[dir]})) continue;
+                int side = c + FourConnected::dy[dir] * width + FourConnected::dx[dir];
+                dstar_update_rhs(side);
+                dstar_update_cell(side);
+            }
+        }
+        changed_cells.clear();
+    }
+    expansions = 0;
+    dstar_expand(obs);
+    // follow the cheapest neighbors from pos to the goal
+    int end = cell_index(goal);
+    int c = start;
+    cache_cells.assign(1, c);
+    while (c != end && dstar_g[c] != std::numeric_limits<PathCost>::max() && cache_cells.size() <= (size_t)width * height) {
+        int x = c % width, y = c / width;
+        int next = -1;
+        PathCost next_cost = std::numeric_limits<PathCost>::max();
+        for (int dir = 0; dir < 4; dir++) {
+            if (!in_bounds({x + FourConnected::dx[dir], y + FourConnected::dy[dir]})) continue;
+            int side = c + FourConnected::dy[dir] * width + FourConnected::dx[dir];
+            if (dstar_g[side] == std::numeric_limits<PathCost>::max()) continue;
+            PathCost cost = cell_costs[side] + dstar_g[side];
+            if (cost < next_cost) {
+                next = side;
+                next_cost = cost;
+            }
+        }
+        cache_cells.push_back(next);
+        c = next;
+    }
+    load_path(cache_cells);
+    if (observer) observer->on_path_found(*this, path);
+    return waypoints;
+}
+
+// start a new search from goal
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::dstar_reset() {
+    int end = cell_index(goal);
+    dstar_g.assign(width * height, std::numeric_limits<PathCost>::max());
+    dstar_rhs.assign(width * height, std::numeric_limits<PathCost>::max());
+    // the keys of D* Lite are ordered by g as well as f, which the bucket queue does not do
+    if (!dstar_border || dstar_border_type != list_type(false)) {
+        dstar_border.reset(make_open_list(list_type(false)));
+        dstar_border_type = list_type(false);
+    }
+    dstar_border->clear(width * height);
+    dstar_goal = goal;
+    dstar_start = pos;
+    dstar_km = 0;
+    dstar_heuristic_type = heuristic_type;
+    dstar_valid = true;
+    changed_cells.clear();
+    dstar_rhs[end] = 0;
+    dstar_border->push(dstar_key(end));
+}
+
+// key of a cell in dstar_border: cells are expanded by lowest min(g, rhs) + heuristic + km, then lowest min(g, rhs);
+// OpenList takes higher g first, so the second part of the key is stored negated
+template <class CellCost, class PathCost>
+OpenEntry BasicCostMap<CellCost, PathCost>::dstar_key(int c) {
+    double k = std::min(dstar_g[c], dstar_rhs[c]);
+    return {k + heuristic(dstar_start, cell_point(c)) + dstar_km, -k, c};
+}
+
+// recompute the rhs of a cell from its neighbors
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::dstar_update_rhs(int c) {
+    if (c == cell_index(dstar_goal)) return;
+    int x = c % width, y = c / width;
+    PathCost rhs = std::numeric_limits<PathCost>::max();
+    for (int dir = 0; dir < 4; dir++) {
+        if (!in_bounds({x + FourConnected::dx[dir], y + FourConnected::dy[dir]})) continue;
+        int side = c + FourConnected::dy[dir] * width + FourConnected::dx[dir];
+        if (dstar_g[side] != std::numeric_limits<PathCost>::max())
+            rhs = std::min(rhs, (PathCost)(cell_costs[side] + dstar_g[side]));
+    }
+    dstar_rhs[c] = rhs;
+}
+
+// add, move or remove a cell in dstar_border depending on its g and rhs
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::dstar_update_cell(int c) {
+    bool queued = dstar_border->contains(c);
+    if (queued) dstar_border->remove(c);
+    if (dstar_g[c] != dstar_rhs[c]) dstar_border->push(dstar_key(c));
+}
+
+// expand cells until the path from pos is known to be minimal
+template <class CellCost, class PathCost>
+template <class Observer>
+void BasicCostMap<CellCost, PathCost>::dstar_expand(Observer& obs) {
+    int start = cell_index(pos);
+    auto before = [](const OpenEntry& a, const OpenEntry& b) { return costlier(b, a); };
+    while (!dstar_border->empty()) {
+        OpenEntry top = dstar_border->top();
+        // the start is done once it is consistent and no cell in the border could still lower its cost
+        if (dstar_g[start] == dstar_rhs[start] && !before(top, dstar_key(start))) break;
+        int c = top.cell;
+        OpenEntry key = dstar_key(c);
+        if (before(top, key)) {
+            // the key is out of date because pos moved since the cell was added
+            dstar_border->remove(c);
+            dstar_border->push(key);
+            continue;
+        }
+        dstar_border->remove(c);
+        expansions++;
+        obs.on_expand(*this, cell_point(c));
+        int x = c % width, y = c / width;
+        if (dstar_g[c] > dstar_rhs[c]) {
+            // cost went down: settle it, and offer the neighbors a path through it
+            dstar_g[c] = dstar_rhs[c];
+            for (int dir = 0; dir < 4; dir++) {
+                if (!in_bounds({x + FourConnected::dx[dir], y + FourConnected::dy[dir]})) continue;
+                int side = c + FourConnected::dy[dir] * width + FourConnected::dx[dir];
+                PathCost new_cost = cell_costs[c] + dstar_g[c];
+                if (new_cost < dstar_rhs[side] && side != cell_index(dstar_goal)) {
+                    dstar_rhs[side] = new_cost;
+                    dstar_update_cell(side);
+                    obs.on_relax(*this, cell_point(side), new_cost);
+                }
+            }
+        }
+        else {
+            // cost went up: forget it, and recompute the cell and the neighbors whose minimum path went through it
+            PathCost old_cost = cell_costs[c] + dstar_g[c];
+            dstar_g[c] = std::numeric_limits<PathCost>::max();
+            dstar_update_rhs(c);
+            dstar_update_cell(c);
+            for (int dir = 0; dir < 4; dir++) {
+                if (!in_bounds({x + FourConnected::dx[dir], y + FourConnected::dy[dir]})) continue;
+                int side = c + FourConnected::dy[dir] * width + FourConnected::dx[dir];
+                if (dstar_rhs[side] == old_cost) {
+                    dstar_update_rhs(side);
+                    dstar_update_cell(side);
+                }
+            }
+        }
+    }
+}
+
+// ----- HPA* -----
+
+// HPA* partitions the map into square clusters of cluster_size cells. Where two clusters touch, their border is split
+// into segments of cluster_size / 4 cells, and the pair of neighboring cells in the middle of each segment becomes two
+// linked abstract nodes. Each cluster stores the cost of the minimum path inside it between every pair of its nodes, so
+// a query is an A* search over the nodes, followed by a refinement of each abstract edge into cells with a search
+// restricted to one cluster. Paths may cost slightly more than the minimum, because they only cross borders at nodes.
+// Changing a cell cost only marks its cluster stale; the next query recomputes the costs of stale clusters.
+
+// find a near-optimal path to goal through the abstract graph
+template <class CellCost, class PathCost>
+template <class Observer>
+deque<point> BasicCostMap<CellCost, PathCost>::find_path_hierarchical(Observer& obs) {
+    if (cluster_size <= 0) {
+        cout << "error: cluster size must be positive\n";
+        exit(1);
+    }
+    if (hpa_built_size != cluster_size) build_clusters();
+    for (int k = 0; k < (int)clusters.size(); k++)
+        if (clusters[k].stale) update_cluster(k);
+    int start = cell_index(pos);
+    int end = cell_index(goal);
+    int ks = cluster_of(start);
+    int kg = cluster_of(end);
+    // the start and the goal are added to the abstract graph as two extra nodes
+    int n = hpa_nodes.size();
+    int s = n, t = n + 1;
+    hpa_cost.assign(n + 2, std::numeric_limits<PathCost>::max());
+    hpa_prev.assign(n + 2, -1);
+    if (!hpa_border || hpa_border_type != list_type(false)) {
+        hpa_border.reset(make_open_list(list_type(false)));
+        hpa_border_type = list_type(false);
+    }
+    hpa_border->clear(n + 2);
+    expansions = 0;
+    auto node_point = [&](int u) { return u == s ? pos : u == t ? goal : cell_point(hpa_nodes[u].cell); };
+    auto relax_node = [&](int u, int v, PathCost new_cost) {
+        if (new_cost >= hpa_cost[v]) return;
+        hpa_cost[v] = new_cost;
+        hpa_prev[v] = u;
+        OpenEntry e = {new_cost + heuristic(node_point(v), goal), (double)new_cost, v};
+        if (hpa_border->contains(v)) hpa_border->decrease_key(e);
+        else hpa_border->push(e);
+        obs.on_relax(*this, node_point(v), new_cost);
+    };
+    // costs from the nodes of the goal's cluster to the goal: a path from the goal to a node v enters v instead of the goal,
+    // so the reverse path costs cell_costs[goal] - cell_costs[v] more
+    HpaCluster& goal_cluster = clusters[kg];
+    cluster_search(kg, end, -1);
+    hpa_to_goal.resize(goal_cluster.nodes.size());
+    for (int j = 0; j < (int)goal_cluster.nodes.size(); j++) {
+        int c = hpa_nodes[goal_cluster.nodes[j]].cell;
+        hpa_to_goal[j] = local_cost[local_index(kg, c)] - cell_costs[c] + cell_costs[end];
+    }
+    // edges from the start to the nodes of its cluster, and to the goal if it is in the same cluster
+    hpa_cost[s] = 0;
+    cluster_search(ks, start, -1);
+    for (int u : clusters[ks].nodes)
+        relax_node(s, u, local_cost[local_index(ks, hpa_nodes[u].cell)]);
+    if (ks == kg) relax_node(s, t, local_cost[local_index(ks, end)]);
+    // A* over the abstract nodes
+    while (!hpa_border->empty()) {
+        int u = hpa_border->pop().cell;
+        if (u == t) break;
+        expansions++;
+        obs.on_expand(*this, node_point(u));
+        HpaNode& node = hpa_nodes[u];
+        HpaCluster& cluster = clusters[node.cluster];
+        int m = cluster.nodes.size();
+        relax_node(u, node.link, hpa_cost[u] + cell_costs[hpa_nodes[node.link].cell]);
+        for (int j = 0; j < m; j++)
+            if (j != node.slot) relax_node(u, cluster.nodes[j], hpa_cost[u] + cluster.costs[node.slot * m + j]);
+        if (node.cluster == kg) relax_node(u, t, hpa_cost[u] + hpa_to_goal[node.slot]);
+    }
+    // refine the abstract path into cells: linked nodes are neighbors, other edges are minimum paths inside a cluster
+    vector<int> chain;
+    for (int u = t; u != -1; u = hpa_prev[u])
+        chain.push_back(u);
+    std::reverse(chain.begin(), chain.end());
+    cache_cells.assign(1, start);
+    for (int i = 1; i < (int)chain.size(); i++) {
+        int u = chain[i - 1], v = chain[i];
+        int a = u == s ? start : hpa_nodes[u].cell;
+        int b = v == t ? end : hpa_nodes[v].cell;
+        if (a == b) continue;
+        if (u != s && v != t && hpa_nodes[u].link == v) {
+            cache_cells.push_back(b);
+            continue;
+        }
+        int k = u == s ? ks : hpa_nodes[u].cluster;
+        cluster_search(k, a, b);
+        int first = cache_cells.size();
+        for (int c = b; c != a; c = local_prev[local_index(k, c)])
+            cache_cells.push_back(c);
+        std::reverse(cache_cells.begin() + first, cache_cells.end());
+    }
+    load_path(cache_cells);
+    if (observer) observer->on_path_found(*this, path);
     return waypoints;
 }
 
-// search results: 0 = untouched, 1 = added to border (evaluating cost), 2 = visited (cost evaluated), 3 = path (minimum cost), 4 = waypoint
-int CostMap::output_search(point p) {
-    return astar_data[p.x][p.y].added ? astar_data[p.x][p.y].added : astar_data[p.x][p.y].visited * 2;
+// partition the map into clusters and place the abstract nodes on their borders
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::build_clusters() {
+    int cs = cluster_size;
+    clusters_x = (width + cs - 1) / cs;
+    int clusters_y = (height + cs - 1) / cs;
+    clusters.assign(clusters_x * clusters_y, HpaCluster());
+    hpa_nodes.clear();
+    for (int k = 0; k < (int)clusters.size(); k++) {
+        HpaCluster& cluster = clusters[k];
+        cluster.x0 = k % clusters_x * cs;
+        cluster.y0 = k / clusters_x * cs;
+        cluster.w = std::min(cs, width - cluster.x0);
+        cluster.h = std::min(cs, height - cluster.y0);
+        cluster.stale = true;
+    }
+    hpa_built_size = cs;
+    // one pair of linked nodes in the middle of each segment of the borders to the right and bottom neighbors
+    int segment = std::max(1, cs / 4);
+    for (int k = 0; k < (int)clusters.size(); k++) {
+        int x0 = clusters[k].x0, y0 = clusters[k].y0, w = clusters[k].w, h = clusters[k].h;
+        if (x0 + w < width)
+            for (int y = y0; y < y0 + h; y += segment) {
+                int mid = y + (std::min(segment, y0 + h - y) - 1) / 2;
+                add_transition(mid * width + x0 + w - 1, mid * width + x0 + w);
+            }
+        if (y0 + h < height)
+            for (int x = x0; x < x0 + w; x += segment) {
+                int mid = x + (std::min(segment, x0 + w - x) - 1) / 2;
+                add_transition((y0 + h - 1) * width + mid, (y0 + h) * width + mid);
+            }
+    }
+}
+
+// add linked abstract nodes for the neighboring cells a and b of different clusters
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::add_transition(int a, int b) {
+    int ia = hpa_nodes.size(), ib = ia + 1;
+    for (int c : {a, b}) {
+        int k = cluster_of(c);
+        hpa_nodes.push_back({c, k, (int)clusters[k].nodes.size(), c == a ? ib : ia});
+        clusters[k].nodes.push_back(hpa_nodes.size() - 1);
+    }
+}
+
+// recompute the costs between the nodes of cluster k
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::update_cluster(int k) {
+    HpaCluster& cluster = clusters[k];
+    int m = cluster.nodes.size();
+    cluster.costs.resize(m * m);
+    for (int i = 0; i < m; i++) {
+        cluster_search(k, hpa_nodes[cluster.nodes[i]].cell, -1);
+        for (int j = 0; j < m; j++)
+            cluster.costs[i * m + j] = local_cost[local_index(k, hpa_nodes[cluster.nodes[j]].cell)];
+    }
+    cluster.stale = false;
+}
+
+// cluster of a cell
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::cluster_of(int c) {
+    return c / width / hpa_built_size * clusters_x + c % width / hpa_built_size;
+}
+
+// index of cell c in the local data of cluster k
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::local_index(int k, int c) {
+    return (c / width - clusters[k].y0) * clusters[k].w + c % width - clusters[k].x0;
 }
 
-// cumulative cost of the minimum path to point p, but replace max double values with 0
-int CostMap::output_path_cost(point p) {
-    return astar_data[p.x][p.y].path_cost == std::numeric_limits<double>::max() ? 0 : astar_data[p.x][p.y].path_cost;
+// find minimum paths from cell from inside cluster k, stopping at cell to if it is not -1 (Dijkstra)
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::cluster_search(int k, int from, int to) {
+    HpaCluster& cluster = clusters[k];
+    local_cost.assign(cluster.w * cluster.h, std::numeric_limits<PathCost>::max());
+    local_prev.assign(cluster.w * cluster.h, -1);
+    using Entry = std::pair<PathCost, int>;
+    std::priority_queue<Entry, vector<Entry>, std::greater<Entry>> open;
+    local_cost[local_index(k, from)] = 0;
+    open.push({0, from});
+    while (!open.empty()) {
+        auto [cost, c] = open.top();
+        open.pop();
+        if (c == to) return;
+        if (cost > local_cost[local_index(k, c)]) continue; // already reached at a lower cost
+        int x = c % width, y = c / width;
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = x + FourConnected::dx[dir], ny = y + FourConnected::dy[dir];
+            if (nx < cluster.x0 || nx >= cluster.x0 + cluster.w || ny < cluster.y0 || ny >= cluster.y0 + cluster.h) continue;
+            int side = ny * width + nx;
+            PathCost new_cost = cost + cell_costs[side];
+            if (new_cost < local_cost[local_index(k, side)]) {
+                local_cost[local_index(k, side)] = new_cost;
+                local_prev[local_index(k, side)] = c;
+                open.push({new_cost, side});
+            }
+        }
+    }
+}
+
+// ----- TILED -----
+
+// A tiled map keeps only some of its cost tiles in memory (see TileStore), so its cells are never indexed as one array.
+// Its searches use A* with search data allocated per tile the first time a search reaches the tile; the data of a tile is
+// reset lazily, like AstarData, when a newer search reaches it, and freed after a search that does not reach it. Instead of an OpenList indexed by cell, the border is a
+// priority queue that may hold outdated entries of a cell; those are skipped when they come out.
+
+// find the optimal path from start to g on a tiled map
+template <class CellCost, class PathCost>
+template <class Observer>
+void BasicCostMap<CellCost, PathCost>::find_path_tiled(point start, point g, Observer& obs) {
+    int ts = tiles.header().tile_size;
+    tile_search.resize(tiles_across(width, ts) * tiles_across(height, ts));
+    tile_search_id++;
+    if (tile_search_id == 0) {
+        for (auto& t : tile_search)
+            if (t) t->id = 0;
+        tile_search_id = 1;
+    }
+    struct Entry {
+        double f;
+        double g;
+        int x;
+        int y;
+    };
+    auto later = [](const Entry& a, const Entry& b) { // same order as costlier
+        if (a.f != b.f) return a.f > b.f;
+        if (a.g != b.g) return a.g < b.g;
+        return a.y != b.y ? a.y > b.y : a.x > b.x;
+    };
+    std::priority_queue<Entry, vector<Entry>, decltype(later)> open(later);
+    expansions = 0;
+    TileSearch& first = tile_data(start.x, start.y);
+    first.path_cost[tile_offset(start.x, start.y)] = 0;
+    first.state[tile_offset(start.x, start.y)] = 1;
+    open.push({heuristic(start, g), 0, start.x, start.y});
+    while (!open.empty()) {
+        Entry e = open.top();
+        open.pop();
+        if (e.x == g.x && e.y == g.y) break;
+        TileSearch& cur = tile_data(e.x, e.y);
+        int offset = tile_offset(e.x, e.y);
+        if (cur.state[offset] == 2 || e.g > cur.path_cost[offset]) continue; // outdated entry
+        cur.state[offset] = 2;
+        expansions++;
+        obs.on_expand(*this, {e.x, e.y});
+        for (int dir = 0; dir < 4; dir++) {
+            point side = {e.x + FourConnected::dx[dir], e.y + FourConnected::dy[dir]};
+            if (!in_bounds(side)) continue;
+            PathCost new_cost = (PathCost)e.g + (CellCost)tiles.get(side.x, side.y);
+            TileSearch& t = tile_data(side.x, side.y);
+            int side_offset = tile_offset(side.x, side.y);
+            if (new_cost < t.path_cost[side_offset]) {
+                t.path_cost[side_offset] = new_cost;
+                t.prev[side_offset] = dir;
+                t.state[side_offset] = 1;
+                open.push({new_cost + heuristic(side, g), (double)new_cost, side.x, side.y});
+                obs.on_relax(*this, side, new_cost);
+            }
+        }
+    }
+    // reconstruct path from end to beginning
+    context.path.clear();
+    context.waypoints.clear();
+    tile_data(g.x, g.y).state[tile_offset(g.x, g.y)] = 2;
+    for (point p = g; p.x != start.x || p.y != start.y;) {
+        context.path.push_front(p);
+        int dir = tile_data(p.x, p.y).prev[tile_offset(p.x, p.y)];
+        p = {p.x - FourConnected::dx[dir], p.y - FourConnected::dy[dir]};
+    }
+    context.path.push_front({start.x, start.y});
+    find_waypoints(context);
+    path.swap(context.path);
+    waypoints.swap(context.waypoints);
+    // free the data of the tiles this search did not reach, so the search data never grows beyond one search
+    int kept = 0;
+    for (int k : tile_search_live)
+        if (tile_search[k]->id == tile_search_id) tile_search_live[kept++] = k;
+        else tile_search[k].reset();
+    tile_search_live.resize(kept);
+}
+
+// memory held by the search data of a tiled map: that of the tiles the last search reached
+template <class CellCost, class PathCost>
+size_t BasicCostMap<CellCost, PathCost>::tile_search_bytes() {
+    size_t bytes = tile_search.capacity() * sizeof(tile_search[0]) + tile_search_live.capacity() * sizeof(int);
+    for (int k : tile_search_live) {
+        TileSearch& t = *tile_search[k];
+        bytes += sizeof(TileSearch) + t.path_cost.capacity() * sizeof(PathCost) + t.prev.capacity() + t.state.capacity();
+    }
+    return bytes;
+}
+
+// search data of the tile of cell (x, y), reset if it is stale
+template <class CellCost, class PathCost>
+typename BasicCostMap<CellCost, PathCost>::TileSearch& BasicCostMap<CellCost, PathCost>::tile_data(int x, int y) {
+    int ts = tiles.header().tile_size;
+    int k = y / ts * tiles_across(width, ts) + x / ts;
+    std::unique_ptr<TileSearch>& t = tile_search[k];
+    if (!t) {
+        t.reset(new TileSearch());
+        tile_search_live.push_back(k);
+    }
+    if (t->id != tile_search_id) {
+        t->path_cost.assign(ts * ts, std::numeric_limits<PathCost>::max());
+        t->prev.assign(ts * ts, -1);
+        t->state.assign(ts * ts, 0);
+        t->id = tile_search_id;
+    }
+    return *t;
+}
+
+// search data of the tile of cell (x, y) if the current search reached it, or null
+template <class CellCost, class PathCost>
+typename BasicCostMap<CellCost, PathCost>::TileSearch* BasicCostMap<CellCost, PathCost>::current_tile_data(int x, int y) {
+    int ts = tiles.header().tile_size;
+    int k = y / ts * tiles_across(width, ts) + x / ts;
+    if (k >= (int)tile_search.size() || !tile_search[k] || tile_search[k]->id != tile_search_id) return nullptr;
+    return tile_search[k].get();
+}
+
+// index of cell (x, y) in the search data of its tile
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::tile_offset(int x, int y) {
+    int ts = tiles.header().tile_size;
+    return y % ts * ts + x % ts;
+}
+
+// ----- FLOW FIELD -----
+
+// A flow field is a Dijkstra search backward from one goal over the whole map: every cell keeps the cost of its minimum
+// path to the goal and the move to the next cell of that path, packed into a byte, so any number of units heading to the
+// same goal read their paths in O(path length) without searching. Like in D* Lite, moving from a cell into a neighbor
+// costs the neighbor's cost, and the cells whose cost was set are remembered until the field is read again. If a
+// changed cell got more expensive, the cells whose path enters it lose their path, and so do the cells whose path runs
+// through them; those cells take the cheapest path of their neighbors that kept one. Changed cells and the cells with a
+// new path are then expanded like in the first search, until every cell has its minimum path again.
+
+// find the minimum path from every cell to g, with the neighbors of connectivity
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::build_flow_field(point g) {
+    if (tiles.is_open()) {
+        cout << "error: a tiled map has no flow field\n";
+        exit(1);
+    }
+    if constexpr (std::is_integral_v<PathCost>) {
+        if (connectivity == 8) {
+            cout << "error: diagonal moves and any-angle lines need floating-point path costs\n";
+            exit(1);
+        }
+    }
+    if (!in_bounds(g)) return;
+    flow_goal = to_world(g);
+    flow_connectivity = connectivity == 8 ? 8 : 4;
+    flow_built = true;
+    flow_stale = true;
+    update_flow_field();
+}
+
+// next cell of the minimum path from p to the flow field goal, or p at the goal
+template <class CellCost, class PathCost>
+point BasicCostMap<CellCost, PathCost>::flow_step(point p) {
+    update_flow_field();
+    if (!in_bounds(p)) return p;
+    return cell_point(flow_next(cell_index(p)));
+}
+
+// cells of the minimum path from p to the flow field goal, from p to the goal
+template <class CellCost, class PathCost>
+deque<point> BasicCostMap<CellCost, PathCost>::flow_path(point p) {
+    update_flow_field();
+    deque<point> cells;
+    if (!in_bounds(p)) return cells;
+    int c = cell_index(p);
+    cells.push_back(p);
+    for (int next = flow_next(c); next != c; next = flow_next(c)) {
+        cells.push_back(cell_point(next));
+        c = next;
+    }
+    return cells;
+}
+
+// cost of the minimum path from p to the flow field goal
+template <class CellCost, class PathCost>
+PathCost BasicCostMap<CellCost, PathCost>::flow_cost(point p) {
+    update_flow_field();
+    if (!in_bounds(p)) return std::numeric_limits<PathCost>::max();
+    return flow_dist[cell_index(p)];
+}
+
+// cell index of the next cell of the minimum path from cell c, or c at the goal
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::flow_next(int c) {
+    int dir = flow_dir[c];
+    if (dir == FLOW_GOAL) return c;
+    return c + EightConnected::dy[dir] * width + EightConnected::dx[dir];
+}
+
+// bring the flow field up to date with the map
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::update_flow_field() {
+    if (!flow_built) {
+        cout << "error: no flow field; call build_flow_field first\n";
+        exit(1);
+    }
+    if (!flow_stale && flow_changed.empty()) return;
+    // the distances of the flow field are integers on the 4-connected grid with integer costs
+    char type = list_type(flow_connectivity == 4);
+    if (!flow_border || flow_border_type != type) {
+        flow_border.reset(make_open_list(type));
+        flow_border_type = type;
+    }
+    flow_border->clear(width * height);
+    expansions = 0;
+    if (flow_stale) {
+        // start over from the goal
+        point g = to_window(flow_goal);
+        if (!in_bounds(g)) {
+            cout << "error: flow field goal out of bounds\n";
+            exit(1);
+        }
+        int end = cell_index(g);
+        flow_dist.assign(width * height, std::numeric_limits<PathCost>::max());
+        flow_dir.assign(width * height, FLOW_GOAL);
+        flow_dist[end] = 0;
+        flow_border->push({0, 0, end});
+        flow_stale = false;
+        flow_changed.clear();
+    }
+    else if (flow_connectivity == 8) flow_update<EightConnected>();
+    else flow_update<FourConnected>();
+    if (flow_connectivity == 8) flow_expand<EightConnected>();
+    else flow_expand<FourConnected>();
+}
+
+// recompute the cells whose minimum path changed with the costs of flow_changed
+template <class CellCost, class PathCost>
+template <class Neighborhood>
+void BasicCostMap<CellCost, PathCost>::flow_update() {
+    // a neighbor whose path enters a changed cell is out of date if the cell got more expensive; it loses its path, and so
+    // does every cell whose path leads to it
+    flow_cells.clear();
+    for (int c : flow_changed) {
+        int x = c % width, y = c / width;
+        for (int i = 0; i < Neighborhood::count; i++) {
+            int nx = x + Neighborhood::dx[i], ny = y + Neighborhood::dy[i];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            int side = ny * width + nx;
+            if (flow_dir[side] != (i ^ 1) || flow_dist[side] == std::numeric_limits<PathCost>::max()) continue;
+            if (flow_dist[side] >= flow_dist[c] + cell_costs[c] * Neighborhood::length[i]) continue;
+            size_t first = flow_cells.size();
+            flow_dist[side] = std::numeric_limits<PathCost>::max();
+            flow_cells.push_back(side);
+            for (size_t k = first; k < flow_cells.size(); k++) {
+                int u = flow_cells[k];
+                int ux = u % width, uy = u / width;
+                for (int j = 0; j < Neighborhood::count; j++) {
+                    int vx = ux + Neighborhood::dx[j], vy = uy + Neighborhood::dy[j];
+                    if (vx < 0 || vx >= width || vy < 0 || vy >= height) continue;
+                    int v = vy * width + vx;
+                    if (flow_dir[v] == (j ^ 1) && flow_dist[v] != std::numeric_limits<PathCost>::max()) {
+                        flow_dist[v] = std::numeric_limits<PathCost>::max();
+                        flow_cells.push_back(v);
+                    }
+                }
+            }
+        }
+    }
+    // the cells that lost their path take the cheapest path of a neighbor that kept one
+    for (int u : flow_cells) {
+        int x = u % width, y = u / width;
+        flow_dir[u] = FLOW_GOAL;
+        for (int i = 0; i < Neighborhood::count; i++) {
+            int nx = x + Neighborhood::dx[i], ny = y + Neighborhood::dy[i];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            int side = ny * width + nx;
+            if (flow_dist[side] == std::numeric_limits<PathCost>::max()) continue;
+            PathCost cost = flow_dist[side] + move_cost(cell_costs[side], Neighborhood::length[i]);
+            if (cost < flow_dist[u]) {
+                flow_dist[u] = cost;
+                flow_dir[u] = i;
+            }
+        }
+        if (flow_dist[u] != std::numeric_limits<PathCost>::max()) flow_border->push({(double)flow_dist[u], 0, u});
+    }
+    // a changed cell that got cheaper offers its neighbors a cheaper path
+    for (int c : flow_changed)
+        if (flow_dist[c] != std::numeric_limits<PathCost>::max() && !flow_border->contains(c))
+            flow_border->push({(double)flow_dist[c], 0, c});
+    flow_changed.clear();
+}
+
+// expand flow_border until every cell has its minimum path
+template <class CellCost, class PathCost>
+template <class Neighborhood>
+void BasicCostMap<CellCost, PathCost>::flow_expand() {
+    while (!flow_border->empty()) {
+        int c = flow_border->pop().cell;
+        expansions++;
+        int x = c % width, y = c / width;
+        for (int i = 0; i < Neighborhood::count; i++) {
+            int nx = x + Neighborhood::dx[i], ny = y + Neighborhood::dy[i];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            int side = ny * width + nx;
+            // the neighbor moves into c with the reverse move
+            PathCost new_cost = flow_dist[c] + move_cost(cell_costs[c], Neighborhood::length[i]);
+            if (new_cost >= flow_dist[side]) continue;
+            flow_dist[side] = new_cost;
+            flow_dir[side] = i ^ 1;
+            if (flow_border->contains(side)) flow_border->decrease_key({(double)new_cost, 0, side});
+            else flow_border->push({(double)new_cost, 0, side});
+        }
+    }
+}
+
+// ----- LANDMARKS -----
+
+// ALT (A*, landmarks and the triangle inequality): the costs of the minimum paths from and to a few landmark cells are
+// found once for every cell. For any cells a and b and landmark L, d(a, b) >= d(L, b) - d(L, a) and
+// d(a, b) >= d(a, L) - d(b, L), and the largest of these bounds is the heuristic of heuristic_type 'l'. Unlike the grid
+// distances it grows with the costs of the cells in the way. The landmarks are spread evenly around the edge of the map,
+// so most cells have one behind them as seen from their goal.
+// Raising a cost keeps the bounds valid; lowering one, reshaping or scrolling does not, and until the table is built
+// again the searches use the Euclidean heuristic. A float table is rounded, so each bound is lowered by the largest
+// rounding error of its two costs.
+
+// place count landmarks and find the minimum path costs from and to each of them, in parallel
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::build_landmarks(int count, int threads) {
+    if (tiles.is_open()) {
+        cout << "error: landmarks need the whole map in memory\n";
+        exit(1);
+    }
+    if (count <= 0) {
+        cout << "error: landmark count must be positive\n";
+        exit(1);
+    }
+    if constexpr (std::is_integral_v<PathCost>) {
+        if (connectivity == 8) {
+            cout << "error: diagonal moves and any-angle lines need floating-point path costs\n";
+            exit(1);
+        }
+    }
+    // spread the landmarks along the edge of the map, clockwise from the top left corner
+    int perimeter = width == 1 || height == 1 ? width * height : 2 * (width + height) - 4;
+    count = std::min(count, perimeter);
+    landmarks.clear();
+    for (int k = 0; k < count; k++) {
+        int d = (long long)k * perimeter / count;
+        point p;
+        if (d < width) p = {d, 0};
+        else if ((d -= width - 1) < height) p = {width - 1, d};
+        else if ((d -= height - 1) < width) p = {width - 1 - d, height - 1};
+        else p = {0, height - 1 - (d - width + 1)};
+        landmarks.push_back(cell_index(p));
+    }
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!pool || pool->size() != threads) {
+        pool.reset(new WorkStealingPool(threads));
+        worker_contexts.clear();
+        worker_contexts.resize(threads);
+    }
+    landmark_scratch.resize(threads);
+    // one search per landmark and direction, each into a column of its own; the interleaved table is then filled a block
+    // of cells at a time, so no two workers write to the same cache line
+    int cells = width * height;
+    vector<vector<LandmarkCost>> columns(2 * count);
+    pool->run(2 * count, [&](int worker, int task) {
+        vector<double>& dist = landmark_scratch[worker];
+        if (connectivity == 8) landmark_search<EightConnected>(landmarks[task / 2], task % 2, dist);
+        else landmark_search<FourConnected>(landmarks[task / 2], task % 2, dist);
+        columns[task].assign(dist.begin(), dist.end());
+    });
+    landmark_costs.resize((size_t)cells * count * 2);
+    const int block = 4096;
+    pool->run((cells + block - 1) / block, [&](int, int task) {
+        for (int c = task * block; c < std::min(cells, (task + 1) * block); c++)
+            for (int t = 0; t < 2 * count; t++)
+                landmark_costs[(size_t)c * count * 2 + t] = columns[t][c];
+    });
+    landmark_connectivity = connectivity;
+    landmarks_valid = true;
+}
+
+// write the landmarks and their path costs to a file
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::save_landmarks(const string& filename) {
+    if (!landmarks_valid) {
+        cout << "error: no landmarks for the current costs; call build_landmarks first\n";
+        exit(1);
+    }
+    LandmarkHeader header = make_landmark_header(width, height, landmarks.size(), landmark_connectivity, sizeof(LandmarkCost), cost_hash());
+    if (!write_landmark_file(filename, header, landmarks.data(), landmark_costs.data(), landmark_costs.size() * sizeof(LandmarkCost))) {
+        cout << "error: cannot write file " << filename << '\n';
+        exit(1);
+    }
+}
+
+// read landmarks written by save_landmarks for a map with the same costs
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::load_landmarks(const string& filename) {
+    LandmarkHeader header;
+    if (!read_landmark_header(filename, header)) {
+        cout << "error: cannot read file " << filename << '\n';
+        exit(1);
+    }
+    if (string(header.magic, 4) != "CLMK" || header.version != LANDMARK_FILE_VERSION) {
+        cout << "error: " << filename << " is not a version " << LANDMARK_FILE_VERSION << " landmark file\n";
+        exit(1);
+    }
+    if (tiles.is_open() || header.width != width || header.height != height || header.cost_size != sizeof(LandmarkCost)
+        || header.count <= 0 || header.cost_hash != cost_hash()) {
+        cout << "error: " << filename << " belongs to a different map\n";
+        exit(1);
+    }
+    landmarks.resize(header.count);
+    landmark_costs.resize((size_t)width * height * header.count * 2);
+    if (!read_landmark_file(filename, header, landmarks.data(), landmark_costs.data(), landmark_costs.size() * sizeof(LandmarkCost))) {
+        cout << "error: size of " << filename << " does not match its header\n";
+        exit(1);
+    }
+    landmark_connectivity = header.connectivity;
+    landmarks_valid = true;
+}
+
+// whether the search of search_type can use the landmark table as its heuristic: the table has to bound the current
+// costs, and the moves of the search have to be moves of the table. The bounds are not symmetric, which bidirectional
+// A*, D* Lite and HPA* assume of their heuristic, and any-angle lines can be cheaper than the paths of the table.
+template <class CellCost, class PathCost>
+bool BasicCostMap<CellCost, PathCost>::use_landmarks() {
+    bool jumping = search_type == 'j' || search_type == 'p';
+    if (!landmarks_valid || (search_type != 'a' && !jumping)) return false;
+    return landmark_connectivity == 8 || connectivity == 4 || jumping;
+}
+
+// find the minimum path costs from a landmark to every cell, or from every cell to it
+template <class CellCost, class PathCost>
+template <class Neighborhood>
+void BasicCostMap<CellCost, PathCost>::landmark_search(int landmark, bool to_landmark, vector<double>& dist) {
+    using Entry = std::pair<double, int>;
+    std::priority_queue<Entry, vector<Entry>, std::greater<Entry>> open;
+    dist.assign(width * height, std::numeric_limits<double>::max());
+    dist[landmark] = 0;
+    open.push({0, landmark});
+    while (!open.empty()) {
+        auto [d, c] = open.top();
+        open.pop();
+        if (d > dist[c]) continue; // outdated entry
+        int x = c % width, y = c / width;
+        for (int i = 0; i < Neighborhood::count; i++) {
+            int nx = x + Neighborhood::dx[i], ny = y + Neighborhood::dy[i];
+            if (nx < 0 || nx >= width || ny < 0 || ny >= height) continue;
+            int side = ny * width + nx;
+            // a path from the landmark moves on into the neighbor, a path to the landmark comes from the neighbor into c
+            double new_cost = d + move_cost(to_landmark ? cell_costs[c] : cell_costs[side], Neighborhood::length[i]);
+            if (new_cost < dist[side]) {
+                dist[side] = new_cost;
+                open.push({new_cost, side});
+            }
+        }
+    }
+}
+
+// lower bound of the cost of the minimum path from cell a to cell b
+template <class CellCost, class PathCost>
+double BasicCostMap<CellCost, PathCost>::landmark_bound(int a, int b) {
+    int n = landmarks.size();
+    const LandmarkCost* at_a = &landmark_costs[(size_t)a * n * 2];
+    const LandmarkCost* at_b = &landmark_costs[(size_t)b * n * 2];
+    double bound = 0;
+    for (int k = 0; k < 2 * n; k += 2) {
+        double from = (double)at_b[k] - at_a[k]; // d(L, b) - d(L, a)
+        double to = (double)at_a[k + 1] - at_b[k + 1]; // d(a, L) - d(b, L)
+        if constexpr (std::is_floating_point_v<LandmarkCost>) {
+            from -= ((double)at_b[k] + at_a[k]) * LANDMARK_ROUNDING;
+            to -= ((double)at_a[k + 1] + at_b[k + 1]) * LANDMARK_ROUNDING;
+        }
+        bound = std::max(bound, std::max(from, to));
+    }
+    return bound;
+}
+
+// hash of the cell costs, to check that a landmark file belongs to the map (FNV-1a of the costs as doubles)
+template <class CellCost, class PathCost>
+uint64_t BasicCostMap<CellCost, PathCost>::cost_hash() {
+    uint64_t hash = 14695981039346656037ull;
+    for (int c = 0; c < width * height; c++) {
+        double cost = cell_costs[c];
+        unsigned char bytes[sizeof(double)];
+        memcpy(bytes, &cost, sizeof(double));
+        for (unsigned char b : bytes)
+            hash = (hash ^ b) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// search results: 0 = untouched, 1 = added to border (evaluating cost), 2 = visited (cost evaluated), 3 = path (minimum cost), 4 = waypoint, 5 = visited and lowered by ARA*
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::output_search(point p) {
+    if (tiles.is_open()) {
+        TileSearch* t = current_tile_data(p.x, p.y);
+        return t ? t->state[tile_offset(p.x, p.y)] : 0;
+    }
+    int c = cell_index(p);
+    AstarData<PathCost>& data = context.astar_data;
+    return data.current(c) ? data.state(c) : 0;
+}
+
+// cumulative cost of the minimum path to point p, but replace max values with 0
+template <class CellCost, class PathCost>
+int BasicCostMap<CellCost, PathCost>::output_path_cost(point p) {
+    PathCost cost = get_path_cost(p);
+    return cost == std::numeric_limits<PathCost>::max() ? 0 : cost;
 }
 
 // print the movement cost of each cell
-void CostMap::print_cell_cost_map() {
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::print_cell_cost_map() {
     cout << "\ncell cost map:\n";
     for (int i = 0; i < height; i++) {
         for (int j = 0; j < width; j++)
-            cout << cell_costs[j][i] << '\t';
+            cout << (double)get_cell_cost({ j, i }) << '\t';
         cout << '\n';
     }
 }
 
 // print the cumulative cost of the minimum path to each cell evaluated so far
-void CostMap::print_path_cost_map() {
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::print_path_cost_map() {
     cout << "\npath cost map:\n";
     for (int i = 0; i < height; i++) {
         for (int j = 0; j < width; j++)
-            cout << output_path_cost({ this, j, i }) << '\t';
+            cout << output_path_cost({ j, i }) << '\t';
         cout << '\n';
     }
 }
 
 // print evaluation status of each cell
-void CostMap::print_search_map() {
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::print_search_map() {
     cout << "\nsearch map:\n";
     for (point pt : path)
-        astar_data[pt.x][pt.y].added = 3;
+        if (tiles.is_open()) tile_data(pt.x, pt.y).state[tile_offset(pt.x, pt.y)] = 3;
+        else context.astar_data.set_state(cell_index(pt), 3);
     for (point pt : waypoints)
-        astar_data[pt.x][pt.y].added = 4;
+        if (tiles.is_open()) tile_data(pt.x, pt.y).state[tile_offset(pt.x, pt.y)] = 4;
+        else context.astar_data.set_state(cell_index(pt), 4);
     for (int i = 0; i < height; i++) {
         for (int j = 0; j < width; j++)
-            cout << output_search({ this, j, i }) << ' ';
+            cout << output_search({ j, i }) << ' ';
         cout << '\n';
     }
 }
 
 // print the coordinates of the cells the path runs through
-void CostMap::print_path() {
+template <class CellCost, class PathCost>
+void BasicCostMap<CellCost, PathCost>::print_path() {
     cout << "\npath coordinates:\n";
     for (point pt : waypoints)
-        cout << pt.x << ',' << pt.y << " (cost = " << astar_data[pt.x][pt.y].path_cost << ")\n";
+        cout << pt.x << ',' << pt.y << " (cost = " << (double)get_path_cost(pt) << ")\n";
 }
+
+using CostMap = BasicCostMap<>;
+using SearchObserver = BasicSearchObserver<CostMap>;
+
+// observer that prints the cost, path cost and search maps and the path after each search, for debugging
+template <class Map>
+class BasicPrintObserver : public BasicSearchObserver<Map> {
+public:
+    void on_path_found(Map& map, const deque<point>& path) {
+        map.print_cell_cost_map();
+        map.print_path_cost_map();
+        map.print_search_map();
+        map.print_path();
+    }
+};
+
+using PrintObserver = BasicPrintObserver<CostMap>;
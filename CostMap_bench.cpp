@@ -0,0 +1,510 @@
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <sys/resource.h>
+#define COSTMAP_STATS
+#include "CostMap.h"
+
+// fill a map with random costs: a quarter of the cells cost 1 to 9, the rest cost 1
+template <class Map>
+void fill_random(Map& A, std::mt19937& rng) {
+    for (int i = 0; i < A.height; i++)
+        for (int j = 0; j < A.width; j++)
+            if (rng() % 4 == 0) A.set_cell_cost({ j, i }, rng() % 9 + 1);
+}
+
+// compare flat A* with HPA* on random queries over an n x n map
+void bench_hierarchical(int n, int queries) {
+    std::mt19937 rng(n);
+    CostMap A(n, n, { 0, 0 }, 1, 'm');
+    A.cache.set_capacity(0);
+    fill_random(A, rng);
+    vector<query> qs;
+    for (int q = 0; q < queries; q++)
+        qs.push_back({ { (int)(rng() % n), (int)(rng() % n) }, { (int)(rng() % n), (int)(rng() % n) } });
+    // flat A*
+    vector<double> flat_costs;
+    double flat_ms = 0;
+    long long flat_expansions = 0;
+    for (query& q : qs) {
+        A.pos = q.start;
+        auto t0 = std::chrono::steady_clock::now();
+        A.find_path(q.goal);
+        flat_ms += elapsed_ms(t0);
+        flat_expansions += A.expansions;
+        flat_costs.push_back(A.get_path_cost(q.goal));
+    }
+    // HPA*, building the clusters on the first query
+    A.search_type = 'h';
+    A.pos = qs[0].start;
+    auto t0 = std::chrono::steady_clock::now();
+    A.find_path(qs[0].goal);
+    double build_ms = elapsed_ms(t0);
+    double hpa_ms = 0, ratio = 0;
+    long long hpa_expansions = 0;
+    for (int q = 0; q < queries; q++) {
+        A.pos = qs[q].start;
+        t0 = std::chrono::steady_clock::now();
+        A.find_path(qs[q].goal);
+        hpa_ms += elapsed_ms(t0);
+        hpa_expansions += A.expansions;
+        ratio += flat_costs[q] > 0 ? A.get_path_cost(qs[q].goal) / flat_costs[q] : 1;
+    }
+    // one cell changes between queries, so one cluster is recomputed each time
+    double update_ms = 0;
+    for (int q = 0; q < queries; q++) {
+        A.set_cell_cost({ (int)(rng() % n), (int)(rng() % n) }, rng() % 9 + 1);
+        A.pos = qs[q].start;
+        t0 = std::chrono::steady_clock::now();
+        A.find_path(qs[q].goal);
+        update_ms += elapsed_ms(t0);
+    }
+    printf("%dx%d (%d queries)\n", n, n, queries);
+    printf("  A*    %10.3f ms/query %12lld expansions/query\n", flat_ms / queries, flat_expansions / queries);
+    printf("  HPA*  %10.3f ms/query %12lld expansions/query  cost %.4fx A*  build %.1f ms  query after 1 change %.3f ms\n",
+           hpa_ms / queries, hpa_expansions / queries, ratio / queries, build_ms, update_ms / queries);
+}
+
+// compare loading an n x n map from the text format with mapping it from the binary format
+void bench_load(int n) {
+    std::mt19937 rng(n);
+    string text_name = "bench_" + std::to_string(n) + ".in";
+    string binary_name = "bench_" + std::to_string(n) + ".map";
+    {
+        CostMap A(n, n, { 0, 0 });
+        fill_random(A, rng);
+        std::ofstream ofs(text_name);
+        ofs << n << ' ' << n << " 0 0 " << n - 1 << ' ' << n - 1 << '\n';
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++)
+                ofs << A.get_cell_cost({ j, i }) << ' ';
+            ofs << '\n';
+        }
+        A.find_path({ n - 1, n - 1 });
+        A.save(binary_name);
+    }
+    // text: parse every cost and set it, like import_and_run in CostMap_test0
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        std::ifstream ifs(text_name);
+        int height, width;
+        point pos, goal;
+        ifs >> height >> width >> pos.x >> pos.y >> goal.x >> goal.y;
+        CostMap A(height, width, pos);
+        double cost;
+        for (int i = 0; i < height; i++)
+            for (int j = 0; j < width; j++) {
+                ifs >> cost;
+                A.set_cell_cost({ j, i }, cost);
+            }
+    }
+    double text_ms = elapsed_ms(t0);
+    // binary: map the file, then read every cost once so the pages are actually loaded
+    t0 = std::chrono::steady_clock::now();
+    CostMap B(binary_name);
+    double map_ms = elapsed_ms(t0);
+    double binary_sum = 0;
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            binary_sum += B.get_cell_cost({ j, i });
+    double touch_ms = elapsed_ms(t0);
+    std::remove(text_name.c_str());
+    std::remove(binary_name.c_str());
+    printf("%dx%d load\n", n, n);
+    printf("  text    %10.1f ms\n", text_ms);
+    printf("  binary  %10.3f ms to map, %.1f ms with a first pass over all cells (checksum %g)\n", map_ms, touch_ms, binary_sum);
+}
+
+// peak resident memory of the process so far, in MB
+double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+// search an n x n tiled map file with a cache of 256 tiles of 64 x 64 cells; the map is written tile by tile, so
+// neither step holds the whole map in memory. Run this mode on its own, since peak RSS covers the whole process.
+void bench_tiled(int n, int queries) {
+    string name = "bench_" + std::to_string(n) + "_tiled.map";
+    MapHeader header = make_map_header(n, n, 1, 0, 0, n - 1, n - 1, 64);
+    auto cost = [](int x, int y) { // a quarter of the cells cost 1 to 9, the rest cost 1
+        unsigned h = x * 73856093u ^ y * 19349663u;
+        h ^= h >> 13;
+        h *= 0x5bd1e995u;
+        h ^= h >> 15;
+        return h % 4 == 0 ? h / 4 % 9 + 1.0 : 1.0;
+    };
+    auto t0 = std::chrono::steady_clock::now();
+    if (!write_tiled_map_file(name, header, cost)) {
+        cout << "error: cannot write file " << name << '\n';
+        exit(1);
+    }
+    double write_ms = elapsed_ms(t0);
+    std::mt19937 rng(n);
+    double search_ms = 0;
+    long long expansions = 0;
+    size_t search_bytes = 0; // largest search data after a query
+    TileStats stats;
+    {
+        CostMap A(name, 'm', 'b', 256);
+        for (int q = 0; q < queries; q++) {
+            // goals within 512 cells of the start, so queries touch a part of the map
+            A.pos = { (int)(rng() % n), (int)(rng() % n) };
+            point goal = { std::clamp(A.pos.x + (int)(rng() % 1024) - 512, 0, n - 1), std::clamp(A.pos.y + (int)(rng() % 1024) - 512, 0, n - 1) };
+            t0 = std::chrono::steady_clock::now();
+            A.find_path(goal);
+            search_ms += elapsed_ms(t0);
+            expansions += A.expansions;
+            search_bytes = std::max(search_bytes, A.tile_search_bytes());
+        }
+        stats = A.tiles.stats();
+    }
+    std::remove(name.c_str());
+    printf("%dx%d tiled (%.0f MB file, %d queries, written in %.0f ms)\n", n, n, (double)n * n * 8 / (1 << 20), queries, write_ms);
+    printf("  A*  %10.3f ms/query %12lld expansions/query  tile hit rate %.5f  %lld tiles read  search data %.1f MB max  peak RSS %.1f MB\n",
+           search_ms / queries, expansions / queries, (double)stats.hits / (stats.hits + stats.misses), stats.misses,
+           search_bytes / (double)(1 << 20), peak_rss_mb());
+}
+
+// fill a map with a maze: corridors of cost 1 on the odd rows and columns, carved by a randomized depth-first search,
+// and walls of cost 100 everywhere else (cells cannot be blocked, so walls are just expensive)
+void fill_maze(CostMap& A, std::mt19937& rng) {
+    int n = A.width;
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            if (i % 2 == 0 || j % 2 == 0) A.set_cell_cost({ j, i }, 100);
+    int rooms = (n - 1) / 2; // rooms per side, at odd coordinates
+    if (rooms == 0) return;
+    vector<char> visited(rooms * rooms, 0);
+    vector<int> stack = { 0 };
+    visited[0] = 1;
+    while (!stack.empty()) {
+        int r = stack.back();
+        int rx = r % rooms, ry = r / rooms;
+        int options[4], count = 0;
+        for (int dir = 0; dir < 4; dir++) {
+            int nx = rx + FourConnected::dx[dir], ny = ry + FourConnected::dy[dir];
+            if (nx >= 0 && nx < rooms && ny >= 0 && ny < rooms && !visited[ny * rooms + nx]) options[count++] = dir;
+        }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int dir = options[rng() % count];
+        int next = (ry + FourConnected::dy[dir]) * rooms + rx + FourConnected::dx[dir];
+        // open the wall between the two rooms
+        A.set_cell_cost({ 2 * rx + 1 + FourConnected::dx[dir], 2 * ry + 1 + FourConnected::dy[dir] }, 1);
+        visited[next] = 1;
+        stack.push_back(next);
+    }
+}
+
+// fill a map with obstacle-like costs: a fraction of the cells (density in percent) cost 50, the rest cost 1
+void fill_obstacles(CostMap& A, std::mt19937& rng, int density) {
+    for (int i = 0; i < A.height; i++)
+        for (int j = 0; j < A.width; j++)
+            if ((int)(rng() % 100) < density) A.set_cell_cost({ j, i }, 50);
+}
+
+// time find_path on generated n x n maps for each search type, and print one CSV line per map and search type:
+// latency percentiles, expansions per second, heap operations per query and peak memory so far
+void bench_suite(int n) {
+    const char* maps[] = { "open", "random-uniform", "obstacles-10", "obstacles-30", "maze" };
+    const char types[] = { 'a', 'p', 'b' };
+    int queries = std::clamp(50 * 256 / n, 3, 50);
+    for (const char* map : maps) {
+        std::mt19937 rng(n);
+        CostMap A(n, n, { 0, 0 }, 1, 'm');
+        A.cache.set_capacity(0);
+        string name = map;
+        if (name == "random-uniform") fill_random(A, rng);
+        else if (name == "obstacles-10") fill_obstacles(A, rng, 10);
+        else if (name == "obstacles-30") fill_obstacles(A, rng, 30);
+        else if (name == "maze") fill_maze(A, rng);
+        vector<query> qs;
+        for (int q = 0; q < queries; q++) {
+            // queries between corridor cells, so maze queries do not start or end in a wall
+            qs.push_back({ { (int)(rng() % (n / 2)) * 2 + 1, (int)(rng() % (n / 2)) * 2 + 1 },
+                           { (int)(rng() % (n / 2)) * 2 + 1, (int)(rng() % (n / 2)) * 2 + 1 } });
+        }
+        for (char type : types) {
+            A.search_type = type;
+            vector<double> ms;
+            long long expansions = 0, heap_operations = 0;
+            for (query& q : qs) {
+                A.pos = q.start;
+                auto t0 = std::chrono::steady_clock::now();
+                A.find_path(q.goal);
+                ms.push_back(elapsed_ms(t0));
+                expansions += A.expansions;
+                heap_operations += A.stats.pushes + A.stats.pops + A.stats.decreases;
+            }
+            double total = 0;
+            for (double t : ms)
+                total += t;
+            std::sort(ms.begin(), ms.end());
+            auto percentile = [&](double p) { return ms[std::min((int)ms.size() - 1, (int)(p * ms.size()))]; };
+            printf("%s,%d,%c,%d,%.4f,%.4f,%.4f,%.4f,%.0f,%lld,%lld,%.1f\n", map, n, type, queries, percentile(0.5),
+                   percentile(0.9), percentile(0.99), ms.back(), expansions / (total / 1000), expansions / queries,
+                   heap_operations / queries, peak_rss_mb());
+            fflush(stdout);
+        }
+    }
+}
+
+// units units head to one goal: one A* search per unit, against one flow field read by every unit, and the update of
+// the flow field after one cell changes
+void bench_flow(int n, int units) {
+    std::mt19937 rng(n);
+    CostMap A(n, n, { 0, 0 }, 1, 'm');
+    A.cache.set_capacity(0);
+    fill_random(A, rng);
+    point goal = { (int)(rng() % n), (int)(rng() % n) };
+    vector<point> starts;
+    for (int u = 0; u < units; u++)
+        starts.push_back({ (int)(rng() % n), (int)(rng() % n) });
+    auto t0 = std::chrono::steady_clock::now();
+    for (point s : starts) {
+        A.pos = s;
+        A.find_path(goal);
+    }
+    double astar_ms = elapsed_ms(t0);
+    t0 = std::chrono::steady_clock::now();
+    A.build_flow_field(goal);
+    double build_ms = elapsed_ms(t0);
+    t0 = std::chrono::steady_clock::now();
+    size_t cells = 0;
+    for (point s : starts)
+        cells += A.flow_path(s).size();
+    double read_ms = elapsed_ms(t0);
+    double update_ms = 0;
+    long long update_expansions = 0;
+    for (int q = 0; q < 20; q++) {
+        A.set_cell_cost({ (int)(rng() % n), (int)(rng() % n) }, rng() % 9 + 1);
+        t0 = std::chrono::steady_clock::now();
+        A.flow_cost(goal);
+        update_ms += elapsed_ms(t0);
+        update_expansions += A.expansions;
+    }
+    printf("%dx%d (%d units)\n", n, n, units);
+    printf("  A* per unit  %10.1f ms\n", astar_ms);
+    printf("  flow field   %10.1f ms  (build %.1f ms, read %.2f ms for %zu path cells)  update after 1 change %.2f ms, %lld expansions\n",
+           build_ms + read_ms, build_ms, read_ms, cells, update_ms / 20, update_expansions / 20);
+}
+
+// length of the straight lines from start through the waypoints
+double waypoint_length(point start, const deque<point>& waypoints) {
+    double length = 0;
+    for (point w : waypoints) {
+        length += std::hypot(w.x - start.x, w.y - start.y);
+        start = w;
+    }
+    return length;
+}
+
+// length, cost and time of the waypoints of A* on the 4- and 8-connected grid, against Theta*, on an open map and on a
+// map where 10% of the cells are expensive
+void bench_any_angle(int n, int queries) {
+    struct Mode {
+        const char* name;
+        char search_type;
+        char heuristic_type;
+        int connectivity;
+    };
+    const Mode modes[] = { { "A* 4", 'a', 'e', 4 }, { "A* 8", 'a', 'o', 8 }, { "Theta*", 't', 'e', 8 } };
+    printf("%dx%d (%d queries)\n", n, n, queries);
+    for (int density : { 0, 10 }) {
+        std::mt19937 rng(n);
+        CostMap A(n, n, { 0, 0 });
+        A.cache.set_capacity(0);
+        fill_obstacles(A, rng, density);
+        vector<query> qs;
+        for (int q = 0; q < queries; q++)
+            qs.push_back({ { (int)(rng() % n), (int)(rng() % n) }, { (int)(rng() % n), (int)(rng() % n) } });
+        for (const Mode& mode : modes) {
+            A.search_type = mode.search_type;
+            A.heuristic_type = mode.heuristic_type;
+            A.connectivity = mode.connectivity;
+            double ms = 0, length = 0, cost = 0;
+            size_t waypoints = 0;
+            for (query& q : qs) {
+                A.pos = q.start;
+                auto t0 = std::chrono::steady_clock::now();
+                A.find_path(q.goal);
+                ms += elapsed_ms(t0);
+                length += waypoint_length(q.start, A.waypoints);
+                cost += A.get_path_cost(q.goal);
+                waypoints += A.waypoints.size();
+            }
+            printf("  %-7s %3d%% expensive %10.3f ms/query  length %9.1f  cost %9.1f  %5.1f waypoints\n", mode.name, density,
+                   ms / queries, length / queries, cost / queries, (double)waypoints / queries);
+        }
+    }
+}
+
+// time the same queries on a random map with the given cost types
+template <class Map>
+void bench_cost_types(const char* name, int n, int queries) {
+    using CellCost = decltype(Map::min);
+    std::mt19937 rng(n);
+    Map A(n, n, { 0, 0 }, 1, 'm');
+    A.cache.set_capacity(0);
+    fill_random(A, rng);
+    double ms = 0, cost = 0;
+    for (int q = 0; q < queries; q++) {
+        A.pos = { (int)(rng() % n), (int)(rng() % n) };
+        point goal = { (int)(rng() % n), (int)(rng() % n) };
+        auto t0 = std::chrono::steady_clock::now();
+        A.find_path(goal);
+        ms += elapsed_ms(t0);
+        cost += A.get_path_cost(goal);
+    }
+    // cell costs, and the search data as allocated by the searches
+    double cells = (double)n * n / (1 << 20);
+    printf("  %-16s %10.3f ms/query  cost %9.1f  cell costs %7.1f MB  search data %7.1f MB\n", name, ms / queries,
+           cost / queries, cells * sizeof(CellCost), A.search_bytes() / (double)(1 << 20));
+}
+
+// A* on byte and 16-bit cell costs with integer path costs, against doubles
+void bench_compact(int n, int queries) {
+    printf("%dx%d (%d queries)\n", n, n, queries);
+    bench_cost_types<CostMap>("double / double", n, queries);
+    bench_cost_types<BasicCostMap<float, float>>("float / float", n, queries);
+    bench_cost_types<BasicCostMap<uint16_t, int>>("uint16 / int", n, queries);
+    bench_cost_types<BasicCostMap<uint8_t, int>>("uint8 / int", n, queries);
+}
+
+// compare the open lists on random queries over an n x n map of terrain costs 1 to 9, with A* and JPS
+void bench_open_lists(int n, int queries) {
+    std::mt19937 rng(n);
+    CostMap A(n, n, { 0, 0 }, 1, 'm');
+    A.cache.set_capacity(0);
+    fill_random(A, rng);
+    vector<query> qs;
+    for (int q = 0; q < queries; q++)
+        qs.push_back({ { (int)(rng() % n), (int)(rng() % n) }, { (int)(rng() % n), (int)(rng() % n) } });
+    printf("%dx%d (%d queries)\n", n, n, queries);
+    for (char s : { 'a', 'j' })
+        for (char o : { 'b', 'q', 'p', 'd' }) {
+            A.search_type = s;
+            A.open_list_type = o;
+            double ms = 0, cost = 0;
+            for (query& q : qs) {
+                A.pos = q.start;
+                auto t0 = std::chrono::steady_clock::now();
+                A.find_path(q.goal);
+                ms += elapsed_ms(t0);
+                cost += A.get_path_cost(q.goal);
+            }
+            const char* name = o == 'b' ? "binary heap" : o == 'q' ? "4-ary heap" : o == 'p' ? "pairing heap" : "bucket queue";
+            printf("  %-4s %-13s %10.3f ms/query  cost %9.1f\n", s == 'a' ? "A*" : "JPS", name, ms / queries, cost / queries);
+        }
+}
+
+// ALT landmarks against Manhattan distance on a map where 30% of the cells are expensive: time and expansions per query,
+// with the time to build the landmark table on all cores and to save and load it
+void bench_landmarks(int n, int queries) {
+    std::mt19937 rng(n);
+    CostMap A(n, n, { 0, 0 }, 1, 'm');
+    A.cache.set_capacity(0);
+    fill_obstacles(A, rng, 30);
+    vector<query> qs;
+    for (int q = 0; q < queries; q++)
+        qs.push_back({ { (int)(rng() % n), (int)(rng() % n) }, { (int)(rng() % n), (int)(rng() % n) } });
+    printf("%dx%d (%d queries)\n", n, n, queries);
+    string name = "bench_" + std::to_string(n) + ".lmk";
+    for (int count : { 8, 16 }) {
+        auto t0 = std::chrono::steady_clock::now();
+        A.build_landmarks(count);
+        double build_ms = elapsed_ms(t0);
+        t0 = std::chrono::steady_clock::now();
+        A.save_landmarks(name);
+        double save_ms = elapsed_ms(t0);
+        t0 = std::chrono::steady_clock::now();
+        A.load_landmarks(name);
+        double load_ms = elapsed_ms(t0);
+        printf("  %2d landmarks: build %9.1f ms  save %7.1f ms  load %7.1f ms  table %7.1f MB\n", count, build_ms, save_ms,
+               load_ms, (double)n * n * count * 2 * sizeof(float) / (1 << 20));
+    }
+    std::remove(name.c_str());
+    for (char s : { 'a', 'p' })
+        for (char h : { 'm', 'l' }) {
+            A.search_type = s;
+            A.heuristic_type = h;
+            double ms = 0, cost = 0;
+            long long expansions = 0;
+            for (query& q : qs) {
+                A.pos = q.start;
+                auto t0 = std::chrono::steady_clock::now();
+                A.find_path(q.goal);
+                ms += elapsed_ms(t0);
+                cost += A.get_path_cost(q.goal);
+                expansions += A.expansions;
+            }
+            printf("  %-5s %-10s %10.3f ms/query  %10lld expansions/query  cost %9.1f\n", s == 'a' ? "A*" : "JPS+",
+                   h == 'm' ? "Manhattan" : "landmarks", ms / queries, expansions / queries, cost / queries);
+        }
+}
+
+// ARA* with a few time budgets against A* on a map where 30% of the cells are expensive: time, cost and bound per query
+void bench_anytime(int n, int queries) {
+    std::mt19937 rng(n);
+    CostMap A(n, n, { 0, 0 }, 1, 'm');
+    A.cache.set_capacity(0);
+    fill_obstacles(A, rng, 30);
+    vector<query> qs;
+    for (int q = 0; q < queries; q++)
+        qs.push_back({ { (int)(rng() % n), (int)(rng() % n) }, { (int)(rng() % n), (int)(rng() % n) } });
+    printf("%dx%d (%d queries)\n", n, n, queries);
+    for (double budget : { -1.0, 0.0, 1.0, 5.0, 1e9 }) {
+        A.search_type = budget < 0 ? 'a' : 'r';
+        A.anytime_budget_ms = budget;
+        double ms = 0, cost = 0, bound = 0, worst = 0;
+        for (query& q : qs) {
+            A.pos = q.start;
+            auto t0 = std::chrono::steady_clock::now();
+            A.find_path(q.goal);
+            double t = elapsed_ms(t0);
+            ms += t;
+            worst = std::max(worst, t);
+            cost += A.get_path_cost(q.goal);
+            bound += A.suboptimality;
+        }
+        string name = budget < 0 ? "A*" : budget > 1e6 ? "ARA* unbounded" : "ARA* " + std::to_string((int)budget) + " ms";
+        printf("  %-15s %10.3f ms/query  %10.3f ms max  cost %9.1f  bound %6.3f\n", name.c_str(), ms / queries, worst,
+               cost / queries, bound / queries);
+    }
+}
+
+// usage: CostMap_bench [suite | hpa | load | tiled | flow | anyangle | compact | openlists | landmarks | anytime] [map size ...]
+// suite runs with map sizes 64 256 1024 4096 by default, the other modes with 256 1024 2048; tiled needs a size
+int main(int argc, char* argv[]) {
+    string mode = argc > 1 ? argv[1] : "suite";
+    vector<int> sizes;
+    for (int i = 2; i < argc; i++)
+        sizes.push_back(std::stoi(argv[i]));
+    if (mode == "suite") {
+        if (sizes.empty()) sizes = { 64, 256, 1024, 4096 };
+        printf("map,size,type,queries,p50_ms,p90_ms,p99_ms,max_ms,expansions_per_s,expansions,heap_operations,peak_rss_mb\n");
+        for (int n : sizes)
+            bench_suite(n);
+        return 0;
+    }
+    if (sizes.empty()) sizes = { 256, 1024, 2048 };
+    for (int n : sizes) {
+        if (mode == "hpa") bench_hierarchical(n, 20);
+        if (mode == "load") bench_load(n);
+        if (mode == "tiled") bench_tiled(n, 20);
+        if (mode == "flow") bench_flow(n, 500);
+        if (mode == "anyangle") bench_any_angle(n, 20);
+        if (mode == "compact") bench_compact(n, 20);
+        if (mode == "openlists") bench_open_lists(n, 20);
+        if (mode == "landmarks") bench_landmarks(n, 20);
+        if (mode == "anytime") bench_anytime(n, 20);
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <string>
+#include <fstream>
+#include <vector>
+#include <iostream>
+#include "MapFile.h"
+
+// Convert a text map (height, width, pos, goal, then one cost per cell) to a binary map file
+int convert(std::string in_name, std::string out_name, double min) {
+    std::ifstream ifs(in_name);
+    if (!ifs) {
+        std::cout << "error: cannot read file " << in_name << '\n';
+        return 1;
+    }
+    int height, width, pos_x, pos_y, goal_x, goal_y;
+    ifs >> height >> width >> pos_x >> pos_y >> goal_x >> goal_y;
+    if (!ifs || height <= 0 || width <= 0) {
+        std::cout << "error: bad header in " << in_name << '\n';
+        return 1;
+    }
+    // the binary loader does not check each cell, so the costs are checked here once
+    std::vector<double> costs((size_t)width * height);
+    for (double& cost : costs) {
+        if (!(ifs >> cost) || cost <= 0) {
+            std::cout << "error: missing or non-positive cost in " << in_name << '\n';
+            return 1;
+        }
+        if (cost < min)
+            std::cout << "warning: cost less than heuristic minimum; solution not guaranteed to be optimal\n";
+    }
+    MapHeader header = make_map_header(width, height, min, pos_x, pos_y, goal_x, goal_y);
+    if (!write_map_file(out_name, header, costs.data())) {
+        std::cout << "error: cannot write file " << out_name << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+// usage: CostMap_convert <text map> <binary map> [min cost, default 1]
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "usage: " << argv[0] << " <text map> <binary map> [min cost]\n";
+        return 1;
+    }
+    return convert(argv[1], argv[2], argc > 3 ? std::stod(argv[3]) : 1);
+}
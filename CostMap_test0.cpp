@@ -9,11 +9,13 @@ int import_and_run(string filename) {
     point pos, goal;
     ifs >> height >> width >> pos.x >> pos.y >> goal.x >> goal.y;
     CostMap A(height, width, pos);
+    PrintObserver printer;
+    A.observer = &printer;
     double cost;
     for (int i = 0; i < height; i++) {
         for (int j = 0; j < width; j++) {
             ifs >> cost;
-            A.set_cell_cost({ &A, j, i }, cost);
+            A.set_cell_cost({ j, i }, cost);
         }
     }
     A.find_path(goal);
@@ -32,7 +34,18 @@ int import_and_run(string filename) {
     return 0;
 }
 
+// Map a binary map file (see CostMap_convert), and run path finder
+int import_binary_and_run(string filename) {
+    CostMap A(filename);
+    PrintObserver printer;
+    A.observer = &printer;
+    A.find_path(A.get_goal());
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) return 0;
-    return import_and_run(argv[1]);
+    string filename = argv[1];
+    if (filename.ends_with(".map")) return import_binary_and_run(filename);
+    return import_and_run(filename);
 }
@@ -6,13 +6,15 @@ int main() {
     srand(time(0));
     int height = rand() % 10 + 10;
     int width = rand() % 10 + 10;
-    point pos = {nullptr, rand() % width, rand() % height};
-    point goal = {nullptr, rand() % width, rand() % height};
+    point pos = {rand() % width, rand() % height};
+    point goal = {rand() % width, rand() % height};
     CostMap A(height, width, pos);
+    PrintObserver printer;
+    A.observer = &printer;
     for (int i = 0; i < height; i++) {
         for (int j = 0; j < width; j++) {
             if (rand() % 8 == 0) {
-                A.set_cell_cost({ &A, j, i }, rand() % 5 + 1);
+                A.set_cell_cost({ j, i }, rand() % 5 + 1);
             }
         }
     }
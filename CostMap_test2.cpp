@@ -0,0 +1,42 @@
+#include <string>
+#include <cstdio>
+#include "CostMap.h"
+
+// load a map file, change a cost and save it back to the same file, then load it again and compare the costs
+bool round_trip(const string& filename, int tile_size) {
+    int height = 512, width = 512;
+    {
+        CostMap A(height, width, { 0, 0 });
+        for (int i = 0; i < height; i++)
+            for (int j = 0; j < width; j++)
+                A.set_cell_cost({ j, i }, (i * 7 + j * 3) % 9 + 1);
+        A.save(filename, tile_size);
+    }
+    {
+        CostMap A(filename);
+        A.set_cell_cost({ 1, 1 }, 20);
+        A.save(filename, tile_size);
+        // changes after the save go to the new file too
+        A.set_cell_cost({ 2, 1 }, 30);
+        A.save(filename, tile_size);
+    }
+    CostMap B(filename);
+    bool ok = true;
+    for (int i = 0; i < height; i++)
+        for (int j = 0; j < width; j++) {
+            double expected = i == 1 && j == 1 ? 20 : i == 1 && j == 2 ? 30 : (i * 7 + j * 3) % 9 + 1;
+            if (B.get_cell_cost({ j, i }) != expected) ok = false;
+        }
+    std::remove(filename.c_str());
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    for (int tile_size : { 0, 64 }) {
+        bool passed = round_trip("test2_" + std::to_string(tile_size) + ".map", tile_size);
+        cout << (tile_size ? "tiled" : "flat") << " map saved over its own file: " << (passed ? "ok" : "costs differ") << '\n';
+        ok = ok && passed;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <random>
+#include "CostMap.h"
+
+// every engine is checked on maps of costs 1 to 9 against A* with a binary heap and no cache, which is kept on a second
+// map with the same costs; costs are integers so that the bucket queue is used where it is selected
+
+// a map of random size whose cells cost 1 to 9, and the reference map with the same costs
+void make_maps(CostMap& A, CostMap& R, std::mt19937& rng) {
+    for (int i = 0; i < A.height; i++)
+        for (int j = 0; j < A.width; j++)
+            if (rng() % 3 == 0) {
+                A.set_cell_cost({ j, i }, rng() % 9 + 1);
+                R.set_cell_cost({ j, i }, A.get_cell_cost({ j, i }));
+            }
+    R.cache.set_capacity(0);
+}
+
+// change the cost of a random cell on both maps
+void change_cost(CostMap& A, CostMap& R, std::mt19937& rng) {
+    point p = { (int)(rng() % A.width), (int)(rng() % A.height) };
+    A.set_cell_cost(p, rng() % 9 + 1);
+    R.set_cell_cost(p, A.get_cell_cost(p));
+}
+
+// cost of the minimum path from start to g on the reference map
+double reference_cost(CostMap& R, point start, point g) {
+    R.pos = start;
+    R.find_path(g);
+    return R.get_path_cost(g);
+}
+
+bool same_cost(double cost, double expected) {
+    return std::abs(cost - expected) <= 1e-9 * std::max(1.0, expected);
+}
+
+// random queries with cost changes in between, searched with the given engine, heuristic, open list and connectivity
+bool check_engine(std::mt19937& rng, char search_type, char heuristic_type, char open_list_type, int connectivity) {
+    bool ok = true;
+    for (int m = 0; m < 100; m++) {
+        int height = rng() % 32 + 1, width = rng() % 32 + 1;
+        CostMap A(height, width, { 0, 0 }, 1, heuristic_type, open_list_type);
+        CostMap R(height, width, { 0, 0 }, 1, 'e', 'b');
+        make_maps(A, R, rng);
+        A.search_type = search_type;
+        A.connectivity = R.connectivity = connectivity;
+        A.anytime_budget_ms = std::numeric_limits<double>::infinity();
+        for (int q = 0; q < 8; q++) {
+            if (q % 4 == 1) change_cost(A, R, rng);
+            // the landmarks are built again after changes, otherwise ALT falls back to Euclidean distance
+            if (heuristic_type == 'l' && q % 4 == 0) A.build_landmarks(rng() % 6 + 1, 1);
+            A.pos = { (int)(rng() % width), (int)(rng() % height) };
+            point goal = { (int)(rng() % width), (int)(rng() % height) };
+            A.find_path(goal);
+            if (!same_cost(A.get_path_cost(goal), reference_cost(R, A.pos, goal))) ok = false;
+        }
+    }
+    return ok;
+}
+
+// D* Lite to a fixed goal while costs change and pos moves along the path
+bool check_dstar(std::mt19937& rng) {
+    bool ok = true;
+    for (int m = 0; m < 100; m++) {
+        int height = rng() % 32 + 1, width = rng() % 32 + 1;
+        CostMap A(height, width, { (int)(rng() % width), (int)(rng() % height) }, 1, 'm');
+        CostMap R(height, width, { 0, 0 }, 1, 'e', 'b');
+        make_maps(A, R, rng);
+        A.search_type = 'd';
+        point goal = { (int)(rng() % width), (int)(rng() % height) };
+        for (int q = 0; q < 8; q++) {
+            int changes = rng() % 4;
+            for (int k = 0; k < changes; k++) change_cost(A, R, rng);
+            if (q % 2 == 1 && A.path.size() > 1) A.pos = A.path[rng() % A.path.size()];
+            A.find_path(goal);
+            if (!same_cost(A.get_path_cost(goal), reference_cost(R, A.pos, goal))) ok = false;
+        }
+    }
+    return ok;
+}
+
+// queries between two cells of a cached path, which the cache answers with the part of the path between them
+bool check_cache(std::mt19937& rng) {
+    bool ok = true;
+    long long subpath_hits = 0;
+    for (int m = 0; m < 100; m++) {
+        int height = rng() % 32 + 1, width = rng() % 32 + 1;
+        CostMap A(height, width, { (int)(rng() % width), (int)(rng() % height) }, 1, 'm');
+        CostMap R(height, width, { 0, 0 }, 1, 'e', 'b');
+        make_maps(A, R, rng);
+        A.find_path({ (int)(rng() % width), (int)(rng() % height) });
+        deque<point> cached = A.path;
+        for (int q = 0; q < 4; q++) {
+            size_t from = rng() % cached.size(), to = rng() % cached.size();
+            if (from > to) std::swap(from, to);
+            A.pos = cached[from];
+            A.find_path(cached[to]);
+            if (!same_cost(A.get_path_cost(cached[to]), reference_cost(R, cached[from], cached[to]))) ok = false;
+        }
+        subpath_hits += A.cache.stats().subpath_hits;
+    }
+    // the queries have to reach the subpath lookup for the check to mean anything
+    return ok && subpath_hits > 0;
+}
+
+// the flow field to a fixed goal, updated after cost changes, against a search from each cell
+bool check_flow_field(std::mt19937& rng, int connectivity) {
+    bool ok = true;
+    for (int m = 0; m < 50; m++) {
+        int height = rng() % 16 + 1, width = rng() % 16 + 1;
+        CostMap A(height, width, { 0, 0 }, 1, 'm');
+        CostMap R(height, width, { 0, 0 }, 1, 'e', 'b');
+        make_maps(A, R, rng);
+        A.connectivity = R.connectivity = connectivity;
+        point goal = { (int)(rng() % width), (int)(rng() % height) };
+        A.build_flow_field(goal);
+        for (int r = 0; r < 4; r++) {
+            int changes = rng() % 4;
+            for (int k = 0; k < changes; k++) change_cost(A, R, rng);
+            for (int i = 0; i < height; i++)
+                for (int j = 0; j < width; j++)
+                    if (!same_cost(A.flow_cost({ j, i }), reference_cost(R, { j, i }, goal))) ok = false;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int seed = argc > 1 ? std::stoi(argv[1]) : 1;
+    std::mt19937 rng(seed);
+    bool ok = true;
+    auto report = [&](const char* name, bool passed) {
+        cout << name << ": " << (passed ? "ok" : "costs differ") << '\n';
+        ok = ok && passed;
+    };
+    report("JPS", check_engine(rng, 'j', 'm', 'b', 4));
+    report("JPS+", check_engine(rng, 'p', 'm', 'b', 4));
+    report("bidirectional A*", check_engine(rng, 'b', 'e', 'b', 4));
+    report("bidirectional A*, 8-connected", check_engine(rng, 'b', 'o', 'b', 8));
+    report("A* with a bucket queue", check_engine(rng, 'a', 'm', 'd', 4));
+    report("JPS with a bucket queue", check_engine(rng, 'j', 'm', 'd', 4));
+    report("ALT", check_engine(rng, 'a', 'l', 'b', 4));
+    report("ALT, 8-connected", check_engine(rng, 'a', 'l', 'b', 8));
+    report("ARA* without a time budget", check_engine(rng, 'r', 'm', 'b', 4));
+    report("ARA* without a time budget, 8-connected", check_engine(rng, 'r', 'm', 'b', 8));
+    report("D* Lite after cost changes and moves", check_dstar(rng));
+    report("cache subpaths", check_cache(rng));
+    report("flow field updates", check_flow_field(rng, 4));
+    report("flow field updates, 8-connected", check_flow_field(rng, 8));
+    cout << "seed " << seed << ": " << (ok ? "ok" : "failed") << '\n';
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#include <cmath>
+#include <algorithm>
+
+// Policies of the grid search, passed as template arguments so the compiler can inline the heuristic and unroll the
+// neighbor loop. CostMap picks them from heuristic_type and connectivity at the start of each search.
+
+// length of a diagonal move
+constexpr double DIAGONAL = 1.4142135623730951;
+
+// heuristics: distance(dx, dy) estimates the length of the minimum path between cells dx >= 0 columns and dy >= 0 rows apart
+struct Manhattan { // tends to overestimate true minimum: _|
+    static double distance(int dx, int dy) { return dx + dy; }
+};
+struct Chebyshev { // tends to underestimate true minimum: |
+    static double distance(int dx, int dy) { return std::max(dx, dy); }
+};
+struct Euclidean { // true minimum: /
+    static double distance(int dx, int dy) { return std::sqrt((double)dx * dx + (double)dy * dy); }
+};
+struct Octile { // exact on an 8-connected grid of uniform cells: straight, then diagonal
+    static double distance(int dx, int dy) { return std::max(dx, dy) + (DIAGONAL - 1) * std::min(dx, dy); }
+};
+struct Landmarks { // no distance of dx and dy: bounds from the path costs of landmark cells (see CostMap::build_landmarks)
+};
+
+// neighborhoods: the moves from a cell to its neighbors, ordered so that move i ^ 1 is the reverse of move i. A move into
+// a neighbor costs the neighbor's cost times the length of the move.
+struct FourConnected { // down (+y), up (-y), right (+x), left (-x); also the directions of JPS, D* Lite, HPA* and tiled searches
+    static constexpr int count = 4;
+    static constexpr int dx[4] = {0, 0, 1, -1};
+    static constexpr int dy[4] = {1, -1, 0, 0};
+    static constexpr double length[4] = {1, 1, 1, 1};
+};
+struct EightConnected { // the four sides, then the four corners
+    static constexpr int count = 8;
+    static constexpr int dx[8] = {0, 0, 1, -1, 1, -1, -1, 1};
+    static constexpr int dy[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+    static constexpr double length[8] = {1, 1, 1, 1, DIAGONAL, DIAGONAL, DIAGONAL, DIAGONAL};
+};
@@ -0,0 +1,338 @@
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <functional>
+#include <list>
+#include <iterator>
+#include <algorithm>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Binary map file: a 64 byte MapHeader followed by width * height doubles of cell costs in row-major order, so the
+// costs start on a cache line and the file can be mapped straight into memory. Numbers are in the byte order of the
+// machine that wrote the file.
+// A tiled map file (tile_size > 0) instead stores the costs tile by tile: the map is cut into tile_size x tile_size
+// tiles, the tiles are stored in row-major order, and each tile stores its cells in row-major order. Tiles on the right
+// and bottom edges are padded to full size, so every tile starts at a fixed offset and can be read on its own.
+const uint32_t MAP_FILE_VERSION = 1;
+
+struct MapHeader {
+    char magic[4]; // "CMAP"
+    uint32_t version; // MAP_FILE_VERSION of the writer
+    int32_t width;
+    int32_t height;
+    double min; // minimum cell cost, used by the heuristic
+    int32_t pos_x, pos_y; // start position
+    int32_t goal_x, goal_y;
+    int32_t tile_size; // 0 = row-major costs, otherwise the width and height of each stored tile
+    char padding[20];
+};
+static_assert(sizeof(MapHeader) == 64, "map costs must start on a cache line");
+
+// header for a map of the given size, start and goal
+inline MapHeader make_map_header(int width, int height, double min, int pos_x, int pos_y, int goal_x, int goal_y, int tile_size = 0) {
+    MapHeader h = {{'C', 'M', 'A', 'P'}, MAP_FILE_VERSION, width, height, min, pos_x, pos_y, goal_x, goal_y, tile_size, {}};
+    return h;
+}
+
+// number of tiles in each row of a tiled map, and in each column
+inline int tiles_across(int cells, int tile_size) {
+    return (cells + tile_size - 1) / tile_size;
+}
+
+// read the header of a map file; return false if the file cannot be read
+inline bool read_map_header(const std::string& filename, MapHeader& header) {
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1;
+    fclose(f);
+    return ok;
+}
+
+// Map files are written to a temporary file that then replaces the target, so a map can be saved back to the file it was
+// loaded from: its mapping and tile reads keep the old file until they close it, instead of reading a truncated file.
+
+// temporary file that a map file is written to before it replaces filename
+inline std::string temp_file_name(const std::string& filename) {
+    return filename + ".tmp";
+}
+
+// close the temporary file of filename, and move it over filename if everything was written or remove it otherwise
+inline bool replace_with_temp_file(FILE* f, bool ok, const std::string& filename) {
+    std::string temp = temp_file_name(filename);
+    ok = fclose(f) == 0 && ok && rename(temp.c_str(), filename.c_str()) == 0;
+    if (!ok) remove(temp.c_str());
+    return ok;
+}
+
+// write a header and its costs to a map file; return false if the file cannot be written
+inline bool write_map_file(const std::string& filename, const MapHeader& header, const double* costs) {
+    FILE* f = fopen(temp_file_name(filename).c_str(), "wb");
+    if (!f) return false;
+    size_t cells = (size_t)header.width * header.height;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(costs, sizeof(double), cells, f) == cells;
+    return replace_with_temp_file(f, ok, filename);
+}
+
+// write a tiled map file with the costs given by cost(x, y), one tile at a time, so the map never has to fit in memory;
+// return false if the file cannot be written
+inline bool write_tiled_map_file(const std::string& filename, const MapHeader& header, std::function<double(int, int)> cost) {
+    FILE* f = fopen(temp_file_name(filename).c_str(), "wb");
+    if (!f) return false;
+    int ts = header.tile_size;
+    std::vector<double> tile((size_t)ts * ts);
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    for (int ty = 0; ok && ty < tiles_across(header.height, ts); ty++)
+        for (int tx = 0; ok && tx < tiles_across(header.width, ts); tx++) {
+            for (int y = 0; y < ts; y++)
+                for (int x = 0; x < ts; x++) {
+                    int cx = tx * ts + x, cy = ty * ts + y;
+                    tile[y * ts + x] = cx < header.width && cy < header.height ? cost(cx, cy) : header.min;
+                }
+            ok = fwrite(tile.data(), sizeof(double), tile.size(), f) == tile.size();
+        }
+    return replace_with_temp_file(f, ok, filename);
+}
+
+// Landmark file: a 64 byte LandmarkHeader, the cell indices of the landmarks as int32, then the landmark table of
+// CostMap::build_landmarks: for each cell, two costs of cost_size bytes per landmark.
+const uint32_t LANDMARK_FILE_VERSION = 1;
+
+struct LandmarkHeader {
+    char magic[4]; // "CLMK"
+    uint32_t version; // LANDMARK_FILE_VERSION of the writer
+    int32_t width;
+    int32_t height;
+    int32_t count; // number of landmarks
+    int32_t connectivity; // neighborhood of the minimum paths
+    int32_t cost_size; // bytes of each cost in the table
+    int32_t padding0;
+    uint64_t cost_hash; // hash of the cell costs the table was built for
+    char padding[24];
+};
+static_assert(sizeof(LandmarkHeader) == 64, "landmark header has a fixed size");
+
+// header for the landmark table of a map
+inline LandmarkHeader make_landmark_header(int width, int height, int count, int connectivity, int cost_size, uint64_t cost_hash) {
+    LandmarkHeader h = {{'C', 'L', 'M', 'K'}, LANDMARK_FILE_VERSION, width, height, count, connectivity, cost_size, 0, cost_hash, {}};
+    return h;
+}
+
+// read the header of a landmark file; return false if the file cannot be read
+inline bool read_landmark_header(const std::string& filename, LandmarkHeader& header) {
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1;
+    fclose(f);
+    return ok;
+}
+
+// write a landmark file with the landmark cells and table_bytes of table; return false if the file cannot be written
+inline bool write_landmark_file(const std::string& filename, const LandmarkHeader& header, const int32_t* cells, const void* table, size_t table_bytes) {
+    FILE* f = fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(cells, sizeof(int32_t), header.count, f) == (size_t)header.count
+              && fwrite(table, 1, table_bytes, f) == table_bytes;
+    return fclose(f) == 0 && ok;
+}
+
+// read the landmark cells and table_bytes of table that follow the header of a landmark file; return false if the file
+// cannot be read or is not exactly that long
+inline bool read_landmark_file(const std::string& filename, const LandmarkHeader& header, int32_t* cells, void* table, size_t table_bytes) {
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    bool ok = fseek(f, sizeof(header), SEEK_SET) == 0 && fread(cells, sizeof(int32_t), header.count, f) == (size_t)header.count
+              && fread(table, 1, table_bytes, f) == table_bytes && fgetc(f) == EOF;
+    fclose(f);
+    return ok;
+}
+
+// private, writable memory mapping of a whole file; writes go to copies of the touched pages, never to the file
+class MappedFile {
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+    // map a file, replacing the current mapping; return false if the file cannot be mapped
+    bool open(const std::string& filename) {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                bytes = (char*)p;
+                length = st.st_size;
+            }
+        }
+        ::close(fd); // the mapping stays valid after the descriptor is closed
+        return bytes != nullptr;
+    }
+    void close() {
+        if (bytes) munmap(bytes, length);
+        bytes = nullptr;
+        length = 0;
+    }
+    char* data() { return bytes; }
+    size_t size() { return length; }
+
+private:
+    char* bytes = nullptr;
+    size_t length = 0;
+};
+
+// hit and miss counts of a TileStore
+struct TileStats {
+    long long hits = 0; // cost reads and writes whose tile was in memory
+    long long misses = 0; // tiles read from the file
+    long long writes = 0; // changed tiles written back to the file
+};
+
+// costs of a tiled map file, read one tile at a time on demand and kept in an LRU cache of a fixed number of tiles.
+// Changed tiles are written back to the file when they leave the cache and when the store is closed.
+class TileStore {
+public:
+    TileStore() {}
+    TileStore(const TileStore&) = delete;
+    TileStore& operator=(const TileStore&) = delete;
+    ~TileStore() { close(); }
+    // open a tiled map file for reading and writing with room for capacity tiles; return false if it cannot be used
+    bool open(const std::string& filename, int capacity) {
+        close();
+        fd = ::open(filename.c_str(), O_RDWR);
+        struct stat st;
+        if (fd < 0 || pread(fd, &head, sizeof(head), 0) != sizeof(head) || head.tile_size <= 0 || fstat(fd, &st) != 0) {
+            close();
+            return false;
+        }
+        tile_cells = head.tile_size * head.tile_size;
+        tiles_x = tiles_across(head.width, head.tile_size);
+        int tiles = tiles_x * tiles_across(head.height, head.tile_size);
+        if (st.st_size != (off_t)(sizeof(head) + (size_t)tiles * tile_cells * sizeof(double))) {
+            close();
+            return false;
+        }
+        slot_of.assign(tiles, -1);
+        set_capacity(capacity);
+        return true;
+    }
+    // write back changed tiles and close the file
+    void close() {
+        for (int s = 0; s < (int)slots.size(); s++)
+            evict(s);
+        slots.clear();
+        order.clear();
+        slot_of.clear();
+        last_tile = -1;
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+    bool is_open() { return fd >= 0; }
+    // whether the store has the file of the given name open
+    bool is_file(const std::string& filename) {
+        struct stat a, b;
+        return fd >= 0 && fstat(fd, &a) == 0 && stat(filename.c_str(), &b) == 0 && a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+    }
+    int capacity() { return slots.size(); } // number of tiles kept in memory
+    const MapHeader& header() { return head; }
+    // change the number of tiles kept in memory (at least 1), dropping the least recently used tiles if needed
+    void set_capacity(int tiles) {
+        tiles = std::max(tiles, 1);
+        while ((int)slots.size() > tiles) {
+            int s = order.back();
+            evict(s);
+            order.pop_back();
+            // the last slot moves into the evicted one
+            int last = slots.size() - 1;
+            if (s != last) {
+                slots[s] = std::move(slots[last]);
+                *slots[s].place = s;
+                if (slots[s].tile >= 0) slot_of[slots[s].tile] = s;
+            }
+            slots.pop_back();
+            last_tile = -1;
+        }
+        while ((int)slots.size() < tiles) {
+            order.push_back(slots.size());
+            slots.push_back({-1, false, std::vector<double>(tile_cells), std::prev(order.end())});
+        }
+    }
+    double get(int x, int y) { return tile(x, y)[y % head.tile_size * head.tile_size + x % head.tile_size]; }
+    void set(int x, int y, double cost) {
+        tile(x, y)[y % head.tile_size * head.tile_size + x % head.tile_size] = cost;
+        slots[last_slot].dirty = true;
+    }
+    TileStats stats() { return counts; }
+    void reset_stats() { counts = TileStats(); }
+
+private:
+    struct Slot { // memory for one tile
+        int tile; // tile in the slot, or -1
+        bool dirty; // costs changed since the tile was read
+        std::vector<double> costs;
+        std::list<int>::iterator place; // position of the slot in order
+    };
+    MapHeader head;
+    int fd = -1;
+    int tile_cells = 0; // cells per tile
+    int tiles_x = 0; // tiles per row
+    std::vector<Slot> slots;
+    std::list<int> order; // slots, most recently used first
+    std::vector<int> slot_of; // slot of each tile, or -1 if it is not in memory
+    int last_tile = -1; // tile of the last access, checked first since searches mostly stay in one tile
+    int last_slot = -1;
+    TileStats counts;
+    // costs of the tile of cell (x, y), reading it from the file if it is not in memory
+    double* tile(int x, int y) {
+        int t = y / head.tile_size * tiles_x + x / head.tile_size;
+        if (t == last_tile) {
+            counts.hits++;
+            return slots[last_slot].costs.data();
+        }
+        int s = slot_of[t];
+        if (s >= 0) counts.hits++;
+        else {
+            // reuse the least recently used slot
+            s = order.back();
+            evict(s);
+            off_t offset = sizeof(head) + (off_t)t * tile_cells * sizeof(double);
+            size_t bytes = tile_cells * sizeof(double);
+            if (pread(fd, slots[s].costs.data(), bytes, offset) != (ssize_t)bytes) {
+                std::cout << "error: cannot read tile " << t << " of map file\n";
+                exit(1);
+            }
+            slots[s].tile = t;
+            slot_of[t] = s;
+            counts.misses++;
+        }
+        order.splice(order.begin(), order, slots[s].place);
+        last_tile = t;
+        last_slot = s;
+        return slots[s].costs.data();
+    }
+    // write a slot's tile back if it changed, and empty the slot
+    void evict(int s) {
+        Slot& slot = slots[s];
+        if (slot.tile < 0) return;
+        if (slot.dirty) {
+            off_t offset = sizeof(head) + (off_t)slot.tile * tile_cells * sizeof(double);
+            size_t bytes = tile_cells * sizeof(double);
+            if (pwrite(fd, slot.costs.data(), bytes, offset) != (ssize_t)bytes) {
+                std::cout << "error: cannot write tile " << slot.tile << " of map file\n";
+                exit(1);
+            }
+            counts.writes++;
+        }
+        slot_of[slot.tile] = -1;
+        slot.tile = -1;
+        slot.dirty = false;
+        if (last_slot == s) last_tile = -1;
+    }
+};
@@ -0,0 +1,316 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using std::vector;
+
+// entry of the open list: a cell with its precomputed total (f = g + h) and path (g) costs
+struct OpenEntry {
+    double f;
+    double g;
+    int cell; // cell index in [0, cell count)
+};
+
+// whether entry a should be expanded after entry b: lower f first, then higher g (closer to the goal), then lower cell index
+inline bool costlier(const OpenEntry& a, const OpenEntry& b) {
+    if (a.f != b.f) return a.f > b.f;
+    if (a.g != b.g) return a.g < b.g;
+    return a.cell > b.cell;
+}
+
+// open list of cells for a best-first search, ordered by costlier so that top() is the cheapest entry
+class OpenList {
+public:
+    virtual ~OpenList() {}
+    virtual void push(OpenEntry e) = 0; // add a cell that is not in the list
+    virtual OpenEntry pop() = 0; // remove and return the cheapest entry
+    virtual OpenEntry top() = 0; // cheapest entry
+    virtual void decrease_key(OpenEntry e) = 0; // lower the costs of a cell that is in the list
+    virtual void remove(int cell) = 0; // remove a cell that is in the list
+    virtual bool contains(int cell) = 0; // whether a cell is in the list
+    virtual bool empty() = 0;
+    virtual int size() = 0;
+    virtual void clear(int cells) = 0; // remove all cells and prepare for cell indices in [0, cells)
+};
+
+// d-ary min heap with a position index per cell, so that decrease_key is O(log n) instead of a full make_heap
+class DaryHeap : public OpenList {
+public:
+    DaryHeap(int d = 2) : arity(d) {}
+    void push(OpenEntry e) {
+        heap.push_back(e);
+        sift_up(heap.size() - 1);
+    }
+    OpenEntry pop() {
+        OpenEntry e = heap[0];
+        position[e.cell] = -1;
+        if (heap.size() > 1) {
+            heap[0] = heap.back();
+            heap.pop_back();
+            sift_down(0);
+        }
+        else heap.pop_back();
+        return e;
+    }
+    OpenEntry top() { return heap[0]; }
+    void decrease_key(OpenEntry e) {
+        int i = position[e.cell];
+        heap[i] = e;
+        sift_up(i);
+    }
+    void remove(int cell) {
+        int i = position[cell];
+        position[cell] = -1;
+        OpenEntry last = heap.back();
+        heap.pop_back();
+        if (i == (int)heap.size()) return;
+        // fill the gap with the last entry, which may have to move either way
+        heap[i] = last;
+        sift_up(i);
+        sift_down(position[last.cell]);
+    }
+    bool contains(int cell) { return position[cell] >= 0; }
+    bool empty() { return heap.empty(); }
+    int size() { return heap.size(); }
+    void clear(int cells) {
+        for (OpenEntry& e : heap)
+            position[e.cell] = -1;
+        heap.clear();
+        position.resize(cells, -1);
+    }
+
+private:
+    int arity;
+    vector<OpenEntry> heap; // entries in heap order
+    vector<int> position; // index of each cell in heap, or -1 if not in the heap
+    // move the entry at index i towards the root until its parent is not more expensive
+    void sift_up(int i) {
+        OpenEntry e = heap[i];
+        while (i > 0) {
+            int parent = (i - 1) / arity;
+            if (!costlier(heap[parent], e)) break;
+            heap[i] = heap[parent];
+            position[heap[i].cell] = i;
+            i = parent;
+        }
+        heap[i] = e;
+        position[e.cell] = i;
+    }
+    // move the entry at index i towards the leaves until none of its children are cheaper
+    void sift_down(int i) {
+        OpenEntry e = heap[i];
+        int n = heap.size();
+        while (true) {
+            int first = i * arity + 1;
+            if (first >= n) break;
+            int last = std::min(first + arity, n);
+            int best = first;
+            for (int c = first + 1; c < last; c++)
+                if (costlier(heap[best], heap[c])) best = c;
+            if (!costlier(e, heap[best])) break;
+            heap[i] = heap[best];
+            position[heap[i].cell] = i;
+            i = best;
+        }
+        heap[i] = e;
+        position[e.cell] = i;
+    }
+};
+
+// pairing heap with one node per cell; push and decrease_key are O(1), pop is amortized O(log n)
+class PairingHeap : public OpenList {
+public:
+    void push(OpenEntry e) {
+        nodes[e.cell] = Node();
+        nodes[e.cell].key = e;
+        nodes[e.cell].in_heap = true;
+        root = root < 0 ? e.cell : meld(root, e.cell);
+        count++;
+    }
+    OpenEntry pop() {
+        int cell = root;
+        nodes[cell].in_heap = false;
+        root = merge_pairs(nodes[cell].child);
+        if (root >= 0) nodes[root].prev = -1;
+        count--;
+        return nodes[cell].key;
+    }
+    OpenEntry top() { return nodes[root].key; }
+    void decrease_key(OpenEntry e) {
+        int cell = e.cell;
+        nodes[cell].key = e;
+        if (cell == root) return;
+        // cut the subtree at cell and meld it back in with the root
+        cut(cell);
+        root = meld(root, cell);
+    }
+    void remove(int cell) {
+        if (cell == root) {
+            pop();
+            return;
+        }
+        // cut the subtree at cell, and meld its children back in with the root
+        cut(cell);
+        nodes[cell].in_heap = false;
+        int sub = merge_pairs(nodes[cell].child);
+        nodes[cell].child = -1;
+        if (sub >= 0) root = meld(root, sub);
+        count--;
+    }
+    bool contains(int cell) { return nodes[cell].in_heap; }
+    bool empty() { return root < 0; }
+    int size() { return count; }
+    void clear(int cells) {
+        // only the nodes still in the heap need to be reset
+        if (root >= 0) {
+            pairs.assign(1, root);
+            while (!pairs.empty()) {
+                int cell = pairs.back();
+                pairs.pop_back();
+                nodes[cell].in_heap = false;
+                for (int c = nodes[cell].child; c >= 0; c = nodes[c].sibling)
+                    pairs.push_back(c);
+            }
+        }
+        nodes.resize(cells);
+        root = -1;
+        count = 0;
+    }
+
+private:
+    struct Node {
+        OpenEntry key;
+        int child = -1; // first child
+        int sibling = -1; // next sibling
+        int prev = -1; // previous sibling, or parent if this is the first child
+        bool in_heap = false;
+    };
+    vector<Node> nodes; // one node per cell
+    vector<int> pairs; // scratch space for merge_pairs
+    int root = -1;
+    int count = 0;
+    // detach the subtree at a cell that is not the root from its parent and siblings
+    void cut(int cell) {
+        Node& n = nodes[cell];
+        if (nodes[n.prev].child == cell) nodes[n.prev].child = n.sibling;
+        else nodes[n.prev].sibling = n.sibling;
+        if (n.sibling >= 0) nodes[n.sibling].prev = n.prev;
+        n.prev = -1;
+        n.sibling = -1;
+    }
+    // make the more expensive of two roots the first child of the other, and return the new root
+    int meld(int a, int b) {
+        if (costlier(nodes[a].key, nodes[b].key)) std::swap(a, b);
+        nodes[b].prev = a;
+        nodes[b].sibling = nodes[a].child;
+        if (nodes[a].child >= 0) nodes[nodes[a].child].prev = b;
+        nodes[a].child = b;
+        return a;
+    }
+    // meld a list of siblings in pairs from left to right, then meld the pairs from right to left
+    int merge_pairs(int first) {
+        if (first < 0) return -1;
+        pairs.clear();
+        for (int a = first; a >= 0;) {
+            int b = nodes[a].sibling;
+            int next = b >= 0 ? nodes[b].sibling : -1;
+            nodes[a].prev = nodes[a].sibling = -1;
+            if (b >= 0) {
+                nodes[b].prev = nodes[b].sibling = -1;
+                a = meld(a, b);
+            }
+            pairs.push_back(a);
+            a = next;
+        }
+        int r = pairs.back();
+        for (int i = pairs.size() - 2; i >= 0; i--)
+            r = meld(pairs[i], r);
+        return r;
+    }
+};
+
+// bucket queue for integer f (Dial's algorithm): one bucket of cells per f value, in a circular array that covers the f
+// values in the list, so push, decrease_key and remove are O(1) and pop scans forward to the next nonempty bucket. The
+// array doubles when an f falls outside it; in a search where a move raises f by at most k, it stays below 2k buckets.
+// Within a bucket the last cell added comes first, which tends to prefer higher g like costlier, but is not exact.
+class BucketQueue : public OpenList {
+public:
+    BucketQueue() : buckets(16) {}
+    void push(OpenEntry e) {
+        long long key = std::llround(e.f);
+        if (count == 0) low = high = key;
+        low = std::min(low, key);
+        high = std::max(high, key);
+        if (high - low >= (long long)buckets.size()) grow();
+        entries[e.cell] = e;
+        vector<int>& b = bucket(key);
+        slot[e.cell] = b.size();
+        b.push_back(e.cell);
+        count++;
+    }
+    OpenEntry pop() {
+        vector<int>& b = first_bucket();
+        int cell = b.back();
+        b.pop_back();
+        slot[cell] = -1;
+        count--;
+        return entries[cell];
+    }
+    OpenEntry top() { return entries[first_bucket().back()]; }
+    void decrease_key(OpenEntry e) {
+        remove(e.cell);
+        push(e);
+    }
+    void remove(int cell) {
+        // fill the gap with the last cell of the bucket
+        vector<int>& b = bucket(std::llround(entries[cell].f));
+        int last = b.back();
+        b[slot[cell]] = last;
+        slot[last] = slot[cell];
+        b.pop_back();
+        slot[cell] = -1;
+        count--;
+    }
+    bool contains(int cell) { return slot[cell] >= 0; }
+    bool empty() { return count == 0; }
+    int size() { return count; }
+    void clear(int cells) {
+        for (vector<int>& b : buckets) {
+            for (int cell : b)
+                slot[cell] = -1;
+            b.clear();
+        }
+        count = 0;
+        entries.resize(cells);
+        slot.resize(cells, -1);
+    }
+
+private:
+    vector<vector<int>> buckets; // cells of each f value, at f modulo the number of buckets (a power of 2)
+    vector<OpenEntry> entries; // entry of each cell in the list
+    vector<int> slot; // index of each cell in its bucket, or -1 if not in the list
+    int count = 0;
+    long long low = 0; // f of every cell in the list is at least low (and is low for some cell after first_bucket)
+    long long high = 0; // f of every cell in the list is at most high
+    vector<int>& bucket(long long key) { return buckets[key & (buckets.size() - 1)]; }
+    // cheapest nonempty bucket
+    vector<int>& first_bucket() {
+        while (bucket(low).empty())
+            low++;
+        return bucket(low);
+    }
+    // double the buckets until they cover [low, high], and move the cells to their new buckets
+    void grow() {
+        size_t n = buckets.size();
+        while (high - low >= (long long)n)
+            n *= 2;
+        vector<vector<int>> old(n);
+        old.swap(buckets);
+        for (vector<int>& b : old)
+            for (int cell : b) {
+                vector<int>& nb = bucket(std::llround(entries[cell].f));
+                slot[cell] = nb.size();
+                nb.push_back(cell);
+            }
+    }
+};
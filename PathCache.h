@@ -0,0 +1,102 @@
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <algorithm>
+
+using std::vector;
+
+// hit and miss counts of a PathCache
+struct CacheStats {
+    long long hits = 0; // queries answered by a path with the same start and goal
+    long long subpath_hits = 0; // queries answered by a part of a longer path
+    long long misses = 0;
+};
+
+// bounded LRU cache of minimum paths, keyed by start cell, goal cell and map version. Any part of a minimum path is
+// itself a minimum path, so a query whose start and goal both lie on a cached path, in that order, is answered by the
+// part between them. Entries of older map versions are never returned and are evicted as they become least recent.
+class PathCache {
+public:
+    PathCache(int capacity = 64) : capacity(capacity) {}
+    // find a path from start to goal in map version; on a hit, set cells to its cells and return true
+    bool lookup(int start, int goal, unsigned long long version, vector<int>& cells) {
+        auto it = index.find(Key{start, goal, version});
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            cells = it->second->cells;
+            counts.hits++;
+            return true;
+        }
+        for (auto e = lru.begin(); e != lru.end(); e++) {
+            if (e->key.version != version) continue;
+            auto from = e->position.find(start);
+            if (from == e->position.end()) continue;
+            auto to = e->position.find(goal);
+            if (to == e->position.end() || to->second < from->second) continue;
+            cells.assign(e->cells.begin() + from->second, e->cells.begin() + to->second + 1);
+            lru.splice(lru.begin(), lru, e);
+            counts.subpath_hits++;
+            return true;
+        }
+        counts.misses++;
+        return false;
+    }
+    // add the path from cells.front() to cells.back() in map version, evicting the least recently used path if full
+    void insert(const vector<int>& cells, unsigned long long version) {
+        if (capacity <= 0 || cells.empty()) return;
+        Key key{cells.front(), cells.back(), version};
+        auto it = index.find(key);
+        if (it != index.end()) {
+            lru.erase(it->second);
+            index.erase(it);
+        }
+        while ((int)lru.size() >= capacity) {
+            index.erase(lru.back().key);
+            lru.pop_back();
+        }
+        lru.push_front(Entry{key, cells});
+        for (int i = 0; i < (int)cells.size(); i++)
+            lru.front().position.emplace(cells[i], i);
+        index[key] = lru.begin();
+    }
+    // remove all paths, keeping the statistics
+    void clear() {
+        lru.clear();
+        index.clear();
+    }
+    // change the number of paths kept; 0 disables the cache
+    void set_capacity(int n) {
+        capacity = n;
+        while ((int)lru.size() > std::max(capacity, 0)) {
+            index.erase(lru.back().key);
+            lru.pop_back();
+        }
+    }
+    int size() { return lru.size(); }
+    CacheStats stats() { return counts; }
+    void reset_stats() { counts = CacheStats(); }
+
+private:
+    struct Key {
+        int start;
+        int goal;
+        unsigned long long version;
+        bool operator==(const Key& k) const { return start == k.start && goal == k.goal && version == k.version; }
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& k) const {
+            std::size_t h = std::hash<unsigned long long>()(k.version);
+            h = h * 31 + std::hash<int>()(k.start);
+            return h * 31 + std::hash<int>()(k.goal);
+        }
+    };
+    struct Entry {
+        Key key;
+        vector<int> cells; // cells of the path, from start to goal
+        std::unordered_map<int, int> position; // index of each cell in cells
+    };
+    int capacity;
+    std::list<Entry> lru; // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    CacheStats counts;
+};
@@ -0,0 +1,106 @@
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <mutex>
+#include <algorithm>
+
+// Search statistics are only collected when COSTMAP_STATS is defined before CostMap.h is included; otherwise the
+// counting and timing code inside STATS(...) compiles away.
+#ifdef COSTMAP_STATS
+#define STATS(code) code
+#else
+#define STATS(code)
+#endif
+
+// milliseconds since t0
+inline double elapsed_ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// statistics of one path query. The relax and border counters cover A*, JPS and bidirectional A*; the other engines
+// report expanded and path_length, and count their whole time as search time.
+struct SearchStats {
+    long long expanded = 0; // cells taken from the border
+    long long relaxed = 0; // path costs lowered
+    long long pushes = 0; // cells added to the border
+    long long pops = 0; // cells taken from the border
+    long long decreases = 0; // cells moved up in the border
+    long long reopened = 0; // visited cells added to the border again
+    int max_open = 0; // largest number of cells in the border
+    long long path_length = 0; // cells in the path, including the start
+    double reset_ms = 0; // preparing the search data and border
+    double search_ms = 0; // expanding the border
+    double reconstruct_ms = 0; // following the path back from the goal
+    double waypoints_ms = 0; // find_waypoints
+};
+
+// totals of many queries, and a histogram of their times; add and write can be called from different threads
+class StatsHistogram {
+public:
+    static const int buckets = 32; // bucket b counts the queries that took at most 2^b microseconds (and more than 2^(b-1))
+    void add(const SearchStats& s) {
+        std::lock_guard<std::mutex> lock(m);
+        double us = (s.reset_ms + s.search_ms + s.reconstruct_ms + s.waypoints_ms) * 1000;
+        int b = 0;
+        while (b < buckets - 1 && us > (double)(1ll << b))
+            b++;
+        counts[b]++;
+        queries++;
+        total_us += us;
+        totals.expanded += s.expanded;
+        totals.relaxed += s.relaxed;
+        totals.pushes += s.pushes;
+        totals.pops += s.pops;
+        totals.decreases += s.decreases;
+        totals.reopened += s.reopened;
+        totals.max_open = std::max(totals.max_open, s.max_open);
+        totals.path_length += s.path_length;
+        totals.reset_ms += s.reset_ms;
+        totals.search_ms += s.search_ms;
+        totals.reconstruct_ms += s.reconstruct_ms;
+        totals.waypoints_ms += s.waypoints_ms;
+    }
+    void clear() {
+        std::lock_guard<std::mutex> lock(m);
+        std::fill(counts, counts + buckets, 0);
+        queries = 0;
+        total_us = 0;
+        totals = SearchStats();
+    }
+    // write the totals and the histogram in the Prometheus text format, for a process that exposes them to a scraper
+    void write(std::ostream& out, const std::string& prefix = "costmap") {
+        std::lock_guard<std::mutex> lock(m);
+        out << "# TYPE " << prefix << "_query_time_us histogram\n";
+        long long cumulative = 0;
+        for (int b = 0; b < buckets - 1; b++) {
+            cumulative += counts[b];
+            out << prefix << "_query_time_us_bucket{le=\"" << (1ll << b) << "\"} " << cumulative << '\n';
+        }
+        out << prefix << "_query_time_us_bucket{le=\"+Inf\"} " << queries << '\n';
+        out << prefix << "_query_time_us_sum " << total_us << '\n';
+        out << prefix << "_query_time_us_count " << queries << '\n';
+        // counters are written as integers where they are counted in integers, so they never lose their last digits
+        auto counter = [&](const char* name, auto value) {
+            out << "# TYPE " << prefix << '_' << name << " counter\n" << prefix << '_' << name << ' ' << value << '\n';
+        };
+        counter("expanded_total", totals.expanded);
+        counter("relaxed_total", totals.relaxed);
+        counter("pushes_total", totals.pushes);
+        counter("pops_total", totals.pops);
+        counter("decreases_total", totals.decreases);
+        counter("reopened_total", totals.reopened);
+        counter("path_length_total", totals.path_length);
+        counter("reset_ms_total", totals.reset_ms);
+        counter("search_ms_total", totals.search_ms);
+        counter("reconstruct_ms_total", totals.reconstruct_ms);
+        counter("waypoints_ms_total", totals.waypoints_ms);
+        out << "# TYPE " << prefix << "_max_open gauge\n" << prefix << "_max_open " << totals.max_open << '\n';
+    }
+
+private:
+    std::mutex m;
+    long long counts[buckets] = {};
+    long long queries = 0;
+    double total_us = 0;
+    SearchStats totals; // sums, except max_open, which is the largest of all queries
+};
@@ -0,0 +1,105 @@
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+using std::vector;
+
+// fixed set of worker threads that run batches of indexed tasks; each worker starts on its own share of the task indices,
+// and when its share runs out it steals half of what is left of another worker's share
+class WorkStealingPool {
+public:
+    WorkStealingPool(int threads) : count(threads), shares(new Share[threads]) {
+        for (int w = 0; w < count; w++)
+            workers.emplace_back(&WorkStealingPool::work, this, w);
+    }
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        start.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+    }
+    int size() { return count; }
+    // run f(worker, task) for every task in [0, tasks) and wait until all are done; worker is in [0, size())
+    void run(int tasks, std::function<void(int, int)> f) {
+        if (tasks <= 0) return;
+        job = f;
+        for (int w = 0; w < count; w++) {
+            shares[w].begin = (long long)tasks * w / count;
+            shares[w].end = (long long)tasks * (w + 1) / count;
+        }
+        std::unique_lock<std::mutex> lock(m);
+        running = count;
+        batch++;
+        start.notify_all();
+        done.wait(lock, [this] { return running == 0; });
+    }
+
+private:
+    struct Share { // task indices [begin, end) that a worker has not started yet
+        std::mutex m;
+        int begin = 0;
+        int end = 0;
+    };
+    int count;
+    vector<std::thread> workers;
+    std::unique_ptr<Share[]> shares;
+    std::function<void(int, int)> job;
+    std::mutex m; // guards batch, running and stopping
+    std::condition_variable start; // a batch was started or the pool is stopping
+    std::condition_variable done; // the last worker finished its part of the batch
+    int batch = 0; // number of batches started
+    int running = 0; // workers that have not finished the current batch
+    bool stopping = false;
+    // wait for batches and run their tasks until the pool stops
+    void work(int w) {
+        int seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                start.wait(lock, [&] { return stopping || batch != seen; });
+                if (stopping) return;
+                seen = batch;
+            }
+            int task;
+            while (next(w, task))
+                job(w, task);
+            std::lock_guard<std::mutex> lock(m);
+            if (--running == 0) done.notify_all();
+        }
+    }
+    // take the next task of worker w's share, or steal from another share; return false when no tasks are left
+    bool next(int w, int& task) {
+        {
+            std::lock_guard<std::mutex> lock(shares[w].m);
+            if (shares[w].begin < shares[w].end) {
+                task = shares[w].begin++;
+                return true;
+            }
+        }
+        for (int i = 1; i < count; i++) {
+            Share& victim = shares[(w + i) % count];
+            int begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.m);
+                int left = victim.end - victim.begin;
+                if (left <= 0) continue;
+                end = victim.end;
+                begin = end - (left + 1) / 2;
+                victim.end = begin;
+            }
+            // run the first stolen task now and keep the rest as the new share (only one lock is held at a time)
+            std::lock_guard<std::mutex> lock(shares[w].m);
+            shares[w].begin = begin + 1;
+            shares[w].end = end;
+            task = begin;
+            return true;
+        }
+        return false;
+    }
+};